@@ -0,0 +1,938 @@
+/**
+ * @brief Host replay benchmark for the physics engine.
+ *
+ * Feeds the captured dt values from FakeISR/TestData.h, as timer cycles,
+ * through RowingEngine<T>::handleRotationImpulse() for every arithmetic type the
+ * engine is instantiated with, and reports the cost per impulse together
+ * with the drift of the final metrics against the double reference.
+ * Each type runs once with runtime RowingSettings and once with the
+ * compile-time StaticRowingSettings. The default type then runs once per
+ * rower model (air, magnetic, water; see RowerModel.h).
+ *
+ * One pass replays TestData.h `loops` times back to back in a single
+ * session, so accumulated sums (total time, distance) grow as they would
+ * in a long workout. The default of 500 loops is roughly 55 minutes.
+ *
+ * The flank detectors (moving average and Savitzky-Golay dt filters,
+ * regression, Kalman) are also replayed on their own, to compare their cost, the
+ * number of drive/recovery flips they see and the jitter of their angular
+ * acceleration; the engine uses the one selected in Kconfig.
+ *
+ * Then one replay runs with a second thread calling getData() in a
+ * tight loop, to report the reader retries of the lock-free publication,
+ * and the per-impulse latency is timed with the stroke stage inline and
+ * on the stroke work queue.
+ *
+ * Then 1, 2 and 4 rowers share one physics thread, the way GpioTimerService
+ * runs CONFIG_ORM_ROWER_COUNT engines, to report the load and headroom.
+ *
+ * Runtime settings are changed through a SettingsStore before, during and
+ * (from a second thread) all through a replay. WarmStart saves the learned
+ * drag factor, the engines are rebuilt as after a reboot and restored from
+ * the saved state, and the first strokes are compared with a cold start. Then the impulse queue is made
+ * to overflow, to compare the rebuilt impulses with the old silent drop.
+ *
+ * Last, a synthetic high-resolution encoder (the replay's flywheel seen by
+ * a disc of ENCODER_SLOTS slots, tens of kHz at the catch) is fed through
+ * ImpulseDecimator into the engine at several decimations, to show the
+ * sustained edge rate and what the bins cost.
+ *
+ * Usage: orm_bench [passes] [loops]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "RowingSettings.h"
+#include "SettingsStore.h"
+#include "SettingsTable.h"
+#include "RowingEngine.h"
+#include "TestData.h"
+#include "ImpulseDecimator.h"
+#include "ImpulseSample.h"
+#include "WarmStart.h"
+#include <zephyr/settings/settings.h>
+
+// TestData.h in k_cycle_get_32() cycles, the way the hardware services see it
+static uint32_t replayCycles[dtCount];
+
+static void convertReplay() {
+    for (size_t i = 0; i < dtCount; i++) {
+        replayCycles[i] = (uint32_t)llround(dtValues[i] * (double)sys_clock_hw_cycles_per_sec());
+    }
+}
+
+struct BenchResult {
+    const char *name;
+    const char *model;
+    const char *settings;
+    double meanNs;
+    double bestNs;
+    int strokes;
+    double totalTime;
+    double distance;
+    double avgSpm;
+    double avgPower;
+    double dragFactor;
+};
+
+template<typename T, typename S, typename M = DefaultRowerModel<T>>
+static BenchResult runReplay(const char *settingsName, int passes, int loops) {
+    double totalNs = 0.0;
+    double bestNs = 0.0;
+    RowingData<T> data;
+
+    for (int pass = 0; pass < passes; pass++) {
+        S settings;
+        RowingEngine<T, S, M> engine(settings);
+        // Stage 2 inline: a replay this fast would overrun the stroke queue
+        engine.setStrokeWorkQueue(nullptr);
+        engine.startSession();
+
+        auto start = std::chrono::steady_clock::now();
+        for (int loop = 0; loop < loops; loop++) {
+            for (size_t i = 0; i < dtCount; i++) {
+                engine.handleRotationImpulse(replayCycles[i]);
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        totalNs += ns;
+        if (pass == 0 || ns < bestNs) bestNs = ns;
+
+        data = engine.getData();
+    }
+
+    double impulses = (double)dtCount * loops;
+    return BenchResult{
+        scalarName<T>(),
+        M::name,
+        settingsName,
+        totalNs / (impulses * passes),
+        bestNs / impulses,
+        data.strokeCount,
+        static_cast<double>(data.totalTime),
+        static_cast<double>(data.distance),
+        static_cast<double>(data.avgSpm),
+        static_cast<double>(data.avgPower),
+        static_cast<double>(data.dragFactor),
+    };
+}
+
+// Replays once while another thread hammers getData(), the way RowerBridge reads.
+static void runContention(int loops) {
+    DefaultRowingSettings<> settings;
+    RowingEngine<> engine(settings);
+    engine.startSession();
+
+    std::atomic<bool> done{false};
+    uint64_t reads = 0;
+    uint64_t tornReads = 0;
+    std::thread reader([&]() {
+        int lastStrokeCount = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            RowingData<> data = engine.getData();
+            // Published snapshots only ever move forward
+            if (data.strokeCount < lastStrokeCount) tornReads++;
+            lastStrokeCount = data.strokeCount;
+            reads++;
+        }
+    });
+
+    for (int loop = 0; loop < loops; loop++) {
+        for (size_t i = 0; i < dtCount; i++) {
+            engine.handleRotationImpulse(replayCycles[i]);
+        }
+    }
+    done.store(true);
+    reader.join();
+
+    printf("\nConcurrent reader (%s): %llu reads, %u retries, %llu inconsistent\n",
+           PHYSICS_SCALAR_NAME, (unsigned long long)reads, engine.getReaderRetries(),
+           (unsigned long long)tornReads);
+}
+
+// Times every handleRotationImpulse() call on its own, stroke stage inline or deferred.
+static void runLatency(int loops, bool deferred) {
+    DefaultRowingSettings<> settings;
+    RowingEngine<> engine(settings);
+    engine.setStrokeWorkQueue(deferred ? rowingStrokeWorkQueue() : nullptr);
+    engine.startSession();
+
+    static double latencyNs[dtCount];
+    double maxNs = 0.0;
+    double totalNs = 0.0;
+    double p999Ns = 0.0;
+    for (int loop = 0; loop < loops; loop++) {
+        for (size_t i = 0; i < dtCount; i++) {
+            auto start = std::chrono::steady_clock::now();
+            engine.handleRotationImpulse(replayCycles[i]);
+            auto end = std::chrono::steady_clock::now();
+            latencyNs[i] = std::chrono::duration<double, std::nano>(end - start).count();
+            totalNs += latencyNs[i];
+            maxNs = std::max(maxNs, latencyNs[i]);
+            // On the rower stage 2 has about a second per record; give it its
+            // time outside the timed window so the queue never overruns
+            if ((i & 255) == 255) engine.flushStrokes();
+        }
+        std::sort(latencyNs, latencyNs + dtCount);
+        p999Ns = std::max(p999Ns, latencyNs[dtCount - 1 - dtCount / 1000]);
+    }
+    engine.flushStrokes();
+
+    RowingData<> data = engine.getData();
+    StrokeStageStats stats = engine.getStrokeStageStats();
+    printf("%-9s %9.1f %9.1f %9.1f %8d %10.2f %8u %8u\n",
+           deferred ? "deferred" : "inline", totalNs / ((double)loops * dtCount), p999Ns, maxNs,
+           data.strokeCount, static_cast<double>(data.distance), stats.processed, stats.dropped);
+}
+
+// Rowers sharing the physics thread. Each replays TestData.h from its own
+// starting point, so the strokes are out of phase, and the impulses are fed
+// in time order, the way the sensor ISRs would queue them.
+// load: physics time per second of rowing.
+// budget: the fastest impulse the engine accepts, shared by all rowers if
+// every sensor fires at once; headroom is the budget over the mean cost.
+static void runMultiRower(int rowers, int loops) {
+    DefaultRowingSettings<> settings;
+    std::vector<std::unique_ptr<RowingEngine<>>> engines;
+    std::vector<size_t> next(rowers);
+    for (int r = 0; r < rowers; r++) {
+        engines.emplace_back(new RowingEngine<>(settings));
+        engines[r]->setStrokeWorkQueue(nullptr);
+        engines[r]->startSession();
+        next[r] = r * dtCount / rowers;
+    }
+
+    // Order of one loop; every rower's loop lasts the same, so it repeats
+    std::vector<uint8_t> order;
+    order.reserve(rowers * dtCount);
+    {
+        std::vector<uint64_t> due(rowers, 0);
+        std::vector<size_t> index(next), left(rowers, dtCount);
+        for (size_t n = 0; n < rowers * dtCount; n++) {
+            int first = -1;
+            for (int r = 0; r < rowers; r++) {
+                if (left[r] == 0) continue;
+                uint64_t at = due[r] + replayCycles[index[r]];
+                if (first < 0 || at < due[first] + replayCycles[index[first]]) first = r;
+            }
+            due[first] += replayCycles[index[first]];
+            if (++index[first] == dtCount) index[first] = 0;
+            left[first]--;
+            order.push_back((uint8_t)first);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < loops; loop++) {
+        for (uint8_t r : order) {
+            engines[r]->handleRotationImpulse(replayCycles[next[r]]);
+            if (++next[r] == dtCount) next[r] = 0;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double rowingSeconds = 0.0;
+    double fastestAccepted = INFINITY;
+    double minimumDt = static_cast<double>(settings.minimumTimeBetweenImpulses);
+    for (size_t i = 0; i < dtCount; i++) {
+        rowingSeconds += dtValues[i];
+        if (dtValues[i] >= minimumDt) fastestAccepted = std::min(fastestAccepted, dtValues[i]);
+    }
+    rowingSeconds *= loops;
+
+    int strokes = 0;
+    for (auto &engine : engines) strokes += engine->getData().strokeCount;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    double meanNs = ns / ((double)order.size() * loops);
+    double budgetNs = fastestAccepted * 1e9 / rowers;
+    printf("%-7d %9.1f %12.0f %10.4f %12.1f %10.0f %8d\n",
+           rowers, meanNs, order.size() * loops / rowingSeconds, 100.0 * ns / (rowingSeconds * 1e9),
+           budgetNs / 1000.0, budgetNs / meanNs, strokes);
+}
+
+// Rolling aggregates of the stroke history, against a full rescan of it
+static void runHistory(int loops) {
+    DefaultRowingSettings<> settings;
+    RowingEngine<> engine(settings);
+    engine.setStrokeWorkQueue(nullptr);
+    engine.startSession();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < loops; loop++) {
+        for (size_t i = 0; i < dtCount; i++) {
+            engine.handleRotationImpulse(replayCycles[i]);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    static StrokeSample<> strokes[CONFIG_ORM_STROKE_HISTORY_LENGTH];
+    int count = engine.getStrokeHistory(strokes, CONFIG_ORM_STROKE_HISTORY_LENGTH);
+    double recentTime = 0.0, recentDistance = 0.0, recentPower = 0.0;
+    double splitTime = 0.0, splitDistance = 0.0, minuteTime = 0.0, peakTorque = 0.0;
+    int minuteStrokes = 0;
+    for (int i = 0; i < count; i++) {
+        double cycle = static_cast<double>(strokes[i].cycleTime());
+        double distance = static_cast<double>(strokes[i].distance);
+        if (i < CONFIG_ORM_RECENT_STROKE_COUNT) {
+            recentTime += cycle;
+            recentDistance += distance;
+            recentPower += static_cast<double>(strokes[i].power());
+        }
+        if (splitDistance < 500.0) {
+            splitTime += cycle;
+            splitDistance += distance;
+        }
+        if (minuteTime < 60.0) {
+            minuteTime += cycle;
+            minuteStrokes++;
+        }
+        peakTorque = std::max(peakTorque, static_cast<double>(strokes[i].peakTorque));
+    }
+    int recentCount = std::min(count, CONFIG_ORM_RECENT_STROKE_COUNT);
+
+    RowingData<> data = engine.getData();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-12s %10s %10s %10s %10s\n", "", "power [W]", "pace [s]", "split [s]", "SPM/min");
+    printf("%-12s %10.2f %10.2f %10.2f %10.2f\n", "incremental", static_cast<double>(data.recentPower),
+           static_cast<double>(data.recentPace), static_cast<double>(data.splitTime),
+           static_cast<double>(data.strokesPerMinute));
+    printf("%-12s %10.2f %10.2f %10.2f %10.2f\n", "rescan", recentPower / recentCount,
+           recentTime * 500.0 / recentDistance, splitTime * 500.0 / splitDistance, minuteStrokes * 60.0 / minuteTime);
+    printf("%d of %d strokes held, peak torque %.1f N·m, %.1f ns/impulse\n", count, data.strokeCount, peakTorque,
+           ns / ((double)dtCount * loops));
+
+    // Concept2 check: kcal/h = 4 * 0.8604 * W + 300 at the defaults
+    printf("Energy: %.1f kcal from %.1f kJ of work, %.0f kcal/h at the last stroke (%.0f expected)\n",
+           static_cast<double>(data.totalEnergy), static_cast<double>(data.totalWork) / 1000.0,
+           static_cast<double>(data.energyPerHour),
+           static_cast<double>(data.instPower) * 3600.0 / (4184.0 * CONFIG_ORM_HUMAN_EFFICIENCY_PERCENT / 100.0) +
+               CONFIG_ORM_BASAL_ENERGY_KCAL_PER_HOUR);
+
+    StrokeQualityData<> quality = engine.getStrokeQuality();
+    printf("Last stroke: drive/recovery %.2f, peak %.1f N·m at %.0f%% of the drive, smoothness %.2f\n",
+           static_cast<double>(quality.driveRecoveryRatio), static_cast<double>(quality.peakTorque),
+           100.0 * static_cast<double>(quality.peakPosition), static_cast<double>(quality.smoothness));
+    printf("%u strokes: power %.1f +/- %.1f W, drive %.1f +/- %.1f rad\n", quality.strokeCount,
+           static_cast<double>(quality.powerMean), static_cast<double>(quality.powerStdDev),
+           static_cast<double>(quality.driveLengthMean), static_cast<double>(quality.driveLengthStdDev));
+}
+
+// Interval workout on the replay: every interval must end exactly on its target
+static void runWorkout(int loops) {
+    DefaultRowingSettings<> settings;
+    RowingEngine<> engine(settings);
+    engine.setStrokeWorkQueue(nullptr);
+    engine.startSession();
+
+    WorkoutProgram program{};
+    program.count = 6;
+    program.intervals[0] = {1000, 0, 1150, IntervalTarget::DISTANCE};
+    program.intervals[1] = {1000, 0, 1150, IntervalTarget::DISTANCE};
+    program.intervals[2] = {120, 0, 0, IntervalTarget::TIME};
+    program.intervals[3] = {120, 0, 0, IntervalTarget::TIME};
+    program.intervals[4] = {40, 0, 0, IntervalTarget::STROKES};
+    program.intervals[5] = {40, 0, 0, IntervalTarget::STROKES};
+    engine.startWorkout(program);
+
+    for (int loop = 0; loop < loops && engine.getWorkoutStatus().state != WorkoutState::DONE; loop++) {
+        for (size_t i = 0; i < dtCount; i++) {
+            engine.handleRotationImpulse(replayCycles[i]);
+        }
+    }
+
+    IntervalSplit<> split;
+    IntervalSplit<> total{};
+    for (int i = 0; engine.getIntervalSplit(i, split); i++) {
+        printf("%-9d %10.3f %10.3f %8.3f %10.2f %10.2f %8.2f\n", i + 1, static_cast<double>(split.time),
+               static_cast<double>(split.distance), static_cast<double>(split.strokes),
+               static_cast<double>(split.avgPace()), static_cast<double>(split.avgPower()),
+               static_cast<double>(split.avgSpm()));
+        total.time += split.time;
+        total.distance += split.distance;
+        total.strokes += split.strokes;
+    }
+    WorkoutStatus<> status = engine.getWorkoutStatus();
+    printf("%-9s %10.3f %10.3f %8.3f   (%s)\n", "sum", static_cast<double>(total.time),
+           static_cast<double>(total.distance), static_cast<double>(total.strokes),
+           status.state == WorkoutState::DONE ? "done" : "not finished");
+}
+
+// The replay with a pause after every loop, as the physics loop would
+// report it: the timeout, then the impulse that spans the stop. Both
+// replays end with a pause, so both have their last recovery credited.
+static void runPause(int loops) {
+    DefaultRowingSettings<> settings;
+    RowingEngine<> continuous(settings), paused(settings);
+    continuous.setStrokeWorkQueue(nullptr);
+    paused.setStrokeWorkQueue(nullptr);
+    continuous.startSession();
+    paused.startSession();
+
+    uint32_t pauseCycles = 60 * sys_clock_hw_cycles_per_sec();
+    double livePower = 0.0, liveSpm = 0.0;
+    for (int loop = 0; loop < loops; loop++) {
+        for (size_t i = 0; i < dtCount; i++) {
+            continuous.handleRotationImpulse(replayCycles[i]);
+            paused.handleRotationImpulse(replayCycles[i]);
+        }
+        paused.handleImpulseTimeout();
+        RowingData<> data = paused.getData();
+        livePower = std::max(livePower, static_cast<double>(data.instPower));
+        liveSpm = std::max(liveSpm, static_cast<double>(data.spm));
+        paused.handleRotationImpulse(pauseCycles);
+    }
+    continuous.handleImpulseTimeout();
+
+    // A resume must not complete a stroke of its own. The stroke count stays
+    // the same, unless a pause cuts a recovery: that stroke is dropped, one
+    // per pause at most. The angle a pause cuts off is still distance: it
+    // may only differ by what the restart leaves out before the first drive.
+    RowingData<> a = continuous.getData(), b = paused.getData();
+    double distanceChange = 100.0 * (static_cast<double>(b.distance) / static_cast<double>(a.distance) - 1.0);
+    char check[64];
+    snprintf(check, sizeof(check), "strokes unchanged, distance %+.2f%%", distanceChange);
+    if (b.strokeCount > a.strokeCount || b.strokeCount + loops < a.strokeCount || std::fabs(distanceChange) > 1.0) {
+        snprintf(check, sizeof(check), "MISMATCH, distance %+.2f%%", distanceChange);
+    } else if (b.strokeCount < a.strokeCount) {
+        snprintf(check, sizeof(check), "%u cut by pauses, distance %+.2f%%", a.strokeCount - b.strokeCount,
+                 distanceChange);
+    }
+    printf("%-10s %12.3f %8u %12.2f %10s %8s\n", "none", static_cast<double>(a.totalTime), a.strokeCount,
+           static_cast<double>(a.distance), "-", "-");
+    printf("%-10d %12.3f %8u %12.2f %10.2f %8.2f   %s\n", loops, static_cast<double>(b.totalTime), b.strokeCount,
+           static_cast<double>(b.distance), livePower, liveSpm, check);
+}
+
+// Runtime settings: smoothing and flank length lowered by one through a
+// SettingsStore. "at start" must match an engine built with those values,
+// "halfway" switches for one loop and back, and during "writer" a second
+// thread republishes unchanged settings all the time, which must not move
+// the result of the unchanged settings.
+static void runSettings(int loops) {
+    using Engine = RowingEngine<PhysicsScalar, RowingSettings<>>;
+    auto replay = [](Engine &engine, int count) {
+        for (int loop = 0; loop < count; loop++) {
+            for (size_t i = 0; i < dtCount; i++) {
+                engine.handleRotationImpulse(replayCycles[i]);
+            }
+        }
+    };
+    auto tune = [](RowingSettings<> &s) {
+        return setSetting(s, SettingId::SMOOTHING, s.smoothing > 1 ? s.smoothing - 1 : 1) &&
+               setSetting(s, SettingId::FLANK_LENGTH, s.flankLength > 1 ? s.flankLength - 1 : 1);
+    };
+    // reference: the run this one must match, nullptr for none
+    auto report = [](const char *name, uint32_t versions, Engine &engine, const RowingData<> *reference) {
+        RowingData<> d = engine.getData();
+        const char *match = "";
+        if (reference != nullptr) {
+            bool same = d.strokeCount == reference->strokeCount && d.distance == reference->distance &&
+                        d.avgPower == reference->avgPower && d.dragFactor == reference->dragFactor;
+            match = same ? "identical" : "MISMATCH";
+        }
+        printf("%-10s %9u %8d %12.2f %10.2f %10.3f   %s\n", name, versions, d.strokeCount,
+               static_cast<double>(d.distance), static_cast<double>(d.avgPower),
+               static_cast<double>(d.dragFactor) * 1e6, match);
+    };
+
+    RowingSettings<> defaults;
+    RowingSettings<> tuned;
+    tune(tuned);
+    tuned.updateDerived();
+    printf("smoothing %d -> %d, flank length %d -> %d\n", defaults.smoothing, tuned.smoothing,
+           defaults.flankLength, tuned.flankLength);
+    printf("%-10s %9s %8s %12s %10s %10s\n", "case", "versions", "strokes", "dist [m]", "power [W]", "drag x1e6");
+
+    Engine plain(defaults), built(tuned);
+    for (Engine *engine : {&plain, &built}) {
+        engine->setStrokeWorkQueue(nullptr);
+        engine->startSession();
+        replay(*engine, loops);
+    }
+    RowingData<> plainData = plain.getData(), builtData = built.getData();
+    report("default", 0, plain, nullptr);
+    report("built", 0, built, nullptr);
+
+    {
+        RowingSettingsStore store(defaults);
+        Engine engine(defaults);
+        engine.setStrokeWorkQueue(nullptr);
+        engine.followSettings(store);
+        engine.startSession();
+        store.update(tune);
+        replay(engine, loops);
+        report("at start", store.getVersion(), engine, &builtData);
+    }
+    {
+        RowingSettingsStore store(defaults);
+        Engine engine(defaults);
+        engine.setStrokeWorkQueue(nullptr);
+        engine.followSettings(store);
+        engine.startSession();
+        replay(engine, loops / 2);
+        store.update(tune);
+        replay(engine, 1);
+        store.update([&](RowingSettings<> &s) { s = defaults; return true; });
+        replay(engine, loops - loops / 2 - 1);
+        report("halfway", store.getVersion(), engine, nullptr);
+    }
+    {
+        RowingSettingsStore store(defaults);
+        Engine engine(defaults);
+        engine.setStrokeWorkQueue(nullptr);
+        engine.followSettings(store);
+        engine.startSession();
+        std::atomic<bool> done{false};
+        std::thread writer([&]() {
+            while (!done.load(std::memory_order_relaxed)) {
+                store.update([](RowingSettings<> &) { return true; });
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        });
+        replay(engine, loops);
+        done.store(true);
+        writer.join();
+        report("writer", store.getVersion(), engine, &plainData);
+    }
+}
+
+// The engines of one boot, built in place the way main.cpp does
+struct Boot {
+    RowingEngine<> engines[CONFIG_ORM_ROWER_COUNT];
+    WarmStart warmStart;
+
+    explicit Boot(const DefaultRowingSettings<> &settings)
+        : Boot(settings, std::make_index_sequence<CONFIG_ORM_ROWER_COUNT>()) {}
+    template<size_t... I>
+    Boot(const DefaultRowingSettings<> &settings, std::index_sequence<I...>)
+        : engines{((void)I, RowingEngine<>(settings))...} {
+        warmStart.init(engines);
+    }
+};
+
+// Warm start across a reboot: rower 0 learns over the whole replay and
+// WarmStart saves it to the flash of the host settings shim, one pass per
+// loop as the interval would, and at the session end. Then the engines are
+// rebuilt and WarmStart::init restores them from that flash. The first
+// strokes of the rebooted rower are compared with a cold start from
+// prj.conf. A saved state of another calibration must be refused at boot.
+static void runWarmStart(int loops) {
+    DefaultRowingSettings<> settings;
+    auto first = std::make_unique<Boot>(settings);
+    RowingEngine<> &learned = first->engines[0];
+    learned.setStrokeWorkQueue(nullptr);
+    learned.startSession();
+    int writesBefore = z_host_settings_writes();
+    for (int loop = 0; loop < loops; loop++) {
+        for (size_t i = 0; i < dtCount; i++) {
+            learned.handleRotationImpulse(replayCycles[i]);
+        }
+        first->warmStart.sessionEnded();
+    }
+    int learnedStrokes = learned.getData().strokeCount;
+    learned.endSession();
+    first->warmStart.sessionEnded();
+    int saves = z_host_settings_writes() - writesBefore;
+    LearnedState saved = learned.getLearnedState();
+    first.reset();
+
+    // Reboot
+    constexpr int STROKES = 8;
+    auto rebooted = std::make_unique<Boot>(settings);
+    RowingEngine<> cold(settings);
+    RowingEngine<> &warm = rebooted->engines[0];
+    double kconfigDrag = cold.getLearnedState().dragFactor;
+    bool restored = warm.getLearnedState().dragFactor == saved.dragFactor && kconfigDrag != saved.dragFactor;
+    for (RowingEngine<> *engine : {&cold, &warm}) {
+        engine->setStrokeWorkQueue(nullptr);
+        engine->startSession();
+        for (int loop = 0; engine->getData().strokeCount <= STROKES && loop < loops; loop++) {
+            for (size_t i = 0; i < dtCount; i++) {
+                engine->handleRotationImpulse(replayCycles[i]);
+            }
+        }
+    }
+
+    // Another calibration wrote rower 0, the next boot starts from prj.conf
+    LearnedState other = saved;
+    other.fingerprint ^= 1;
+    settings_save_one("orm/learned/0", &other, sizeof(other));
+    auto recalibrated = std::make_unique<Boot>(settings);
+    bool refused = recalibrated->engines[0].getLearnedState().dragFactor == kconfigDrag;
+    settings_save_one("orm/learned/0", &saved, sizeof(saved));
+
+    printf("learned drag %.3f x1e6 over %d strokes, %d saves at a %.1f%% threshold, %zu bytes, "
+           "restored after a reboot: %s, other calibration refused: %s\n",
+           saved.dragFactor * 1e6, learnedStrokes, saves, CONFIG_ORM_WARM_START_MIN_CHANGE_PERMILLE / 10.0,
+           sizeof(LearnedState), restored ? "yes" : "NO", refused ? "yes" : "NO");
+    static StrokeSample<> coldStrokes[CONFIG_ORM_STROKE_HISTORY_LENGTH], warmStrokes[CONFIG_ORM_STROKE_HISTORY_LENGTH];
+    int coldCount = cold.getStrokeHistory(coldStrokes, CONFIG_ORM_STROKE_HISTORY_LENGTH);
+    int warmCount = warm.getStrokeHistory(warmStrokes, CONFIG_ORM_STROKE_HISTORY_LENGTH);
+    printf("%-7s %16s %12s %16s %12s\n", "stroke", "cold drag x1e6", "power [W]", "warm drag x1e6", "power [W]");
+    for (int i = 0; i < STROKES && i < coldCount && i < warmCount; i++) {
+        // The history is newest first
+        const StrokeSample<> &c = coldStrokes[coldCount - 1 - i], &w = warmStrokes[warmCount - 1 - i];
+        printf("%-7d %16.3f %12.2f %16.3f %12.2f\n", i + 1, static_cast<double>(c.dragFactor) * 1e6,
+               static_cast<double>(c.power()), static_cast<double>(w.dragFactor) * 1e6,
+               static_cast<double>(w.power()));
+    }
+}
+
+// Stress on the impulse queue: the physics thread stalls for STALL of
+// every PERIOD impulses while the sensor fills a queue of QUEUE entries.
+// "counted" carries the lost impulses with the next sample, the way the
+// timer services do; "ignored" drops them silently, the way the ISR used to.
+// PERIOD shares no factor with the replay, so the stalls sweep every part
+// of the stroke. "drag avg" is the learned drag factor averaged per loop,
+// the last value alone swings with the median of the last strokes.
+static void runOverflow(int loops) {
+    constexpr size_t QUEUE = 8;
+    constexpr size_t PERIOD = 401;
+    constexpr size_t STALL = 60;
+    DefaultRowingSettings<> settings;
+    RowingEngine<> reference(settings), counted(settings), ignored(settings);
+    for (RowingEngine<> *engine : {&reference, &counted, &ignored}) {
+        engine->setStrokeWorkQueue(nullptr);
+        engine->startSession();
+    }
+
+    std::deque<ImpulseSample> countedQueue;
+    std::deque<uint32_t> ignoredQueue;
+    ImpulseLossCounter losses;
+    losses.setGate(counted.getMinimumImpulseCycles(), counted.getMaximumImpulseCycles());
+    uint32_t ignoredLost = 0;
+    auto drain = [&]() {
+        for (const ImpulseSample &sample : countedQueue) {
+            counted.handleRotationImpulse(sample.deltaCycles, sample.missed);
+        }
+        for (uint32_t delta : ignoredQueue) {
+            ignored.handleRotationImpulse(delta);
+        }
+        countedQueue.clear();
+        ignoredQueue.clear();
+    };
+
+    double dragSum[3] = {};
+    size_t impulse = 0;
+    for (int loop = 0; loop < loops; loop++) {
+        for (size_t i = 0; i < dtCount; i++, impulse++) {
+            reference.handleRotationImpulse(replayCycles[i]);
+            losses.offer(replayCycles[i], [&](const ImpulseSample &sample) {
+                if (countedQueue.size() >= QUEUE) return false;
+                countedQueue.push_back(sample);
+                return true;
+            });
+            if (ignoredQueue.size() < QUEUE) {
+                ignoredQueue.push_back(replayCycles[i]);
+            } else {
+                ignoredLost++;
+            }
+            if (impulse % PERIOD >= STALL) {
+                drain();
+            }
+        }
+        dragSum[0] += static_cast<double>(reference.getData().dragFactor);
+        dragSum[1] += static_cast<double>(counted.getData().dragFactor);
+        dragSum[2] += static_cast<double>(ignored.getData().dragFactor);
+    }
+    drain();
+
+    printf("queue %zu, stall %zu of every %zu impulses\n", QUEUE, STALL, PERIOD);
+    printf("%-10s %8s %8s %8s %12s %12s %10s %10s %10s %10s %10s\n", "impulses", "lost", "engine", "strokes",
+           "time [s]", "dist [m]", "power [W]", "drag x1e6", "drag avg", "dist [%]", "power [%]");
+    RowingData<> ref = reference.getData();
+    auto report = [&](const char *name, uint32_t lost, RowingEngine<> &engine, double dragAverage) {
+        RowingData<> d = engine.getData();
+        printf("%-10s %8u %8u %8d %12.3f %12.2f %10.2f %10.3f %10.3f %10.2f %10.2f\n", name, lost,
+               engine.getMissedImpulses(), d.strokeCount, static_cast<double>(d.totalTime),
+               static_cast<double>(d.distance), static_cast<double>(d.avgPower),
+               static_cast<double>(d.dragFactor) * 1e6, dragAverage / loops * 1e6,
+               100.0 * (static_cast<double>(d.distance) / static_cast<double>(ref.distance) - 1.0),
+               100.0 * (static_cast<double>(d.avgPower) / static_cast<double>(ref.avgPower) - 1.0));
+    };
+    report("all", 0, reference, dragSum[0]);
+    report("counted", losses.getTotalLost(), counted, dragSum[1]);
+    report("ignored", ignoredLost, ignored, dragSum[2]);
+}
+
+// Synthetic encoder disc. Bounces of the replay are merged into the magnet
+// interval they belong to, the angular velocity is interpolated linearly
+// between the midpoints of the magnet intervals, and an edge is emitted
+// every slot. Returns one replay loop of edges, in cycles.
+static constexpr int ENCODER_SLOTS = 960;
+
+static std::vector<uint32_t> synthesizeEncoder(double &seconds) {
+    DefaultRowingSettings<> settings;
+    const double minimumDt = static_cast<double>(settings.minimumTimeBetweenImpulses);
+    const double magnetAngle = 2.0 * M_PI / CONFIG_ORM_IMPULSES_PER_REV;
+    const double slotAngle = 2.0 * M_PI / ENCODER_SLOTS;
+    const double rate = (double)sys_clock_hw_cycles_per_sec();
+
+    // (midpoint time, angular velocity) of every magnet interval
+    std::vector<double> midTime, velocity;
+    double t = 0.0, pending = 0.0;
+    for (size_t i = 0; i < dtCount; i++) {
+        pending += dtValues[i];
+        if (pending < minimumDt) continue;
+        midTime.push_back(t + pending / 2.0);
+        velocity.push_back(magnetAngle / pending);
+        t += pending;
+        pending = 0.0;
+    }
+    seconds = t;
+
+    std::vector<uint32_t> edges;
+    const double step = 2e-6;
+    double angle = 0.0, nextSlot = slotAngle;
+    int64_t lastEdgeCycles = 0;
+    size_t k = 0;
+    for (double now = 0.0; now < seconds; now += step) {
+        while (k + 1 < midTime.size() && midTime[k + 1] < now) k++;
+        double w = velocity[k];
+        if (k + 1 < midTime.size() && now > midTime[k]) {
+            w += (velocity[k + 1] - velocity[k]) * (now - midTime[k]) / (midTime[k + 1] - midTime[k]);
+        }
+        double nextAngle = angle + w * step;
+        while (nextAngle >= nextSlot) {
+            double edgeTime = now + step * (nextSlot - angle) / (nextAngle - angle);
+            int64_t edgeCycles = llround(edgeTime * rate);
+            edges.push_back((uint32_t)(edgeCycles - lastEdgeCycles));
+            lastEdgeCycles = edgeCycles;
+            nextSlot += slotAngle;
+        }
+        angle = nextAngle;
+    }
+    return edges;
+}
+
+// Edges through ImpulseDecimator<D> into the engine. The timing limits of
+// the settings count bins, so they are scaled from magnets to bins; the
+// analysis steps stay at the magnets. Strokes, distance and drag have to
+// match the ones of reference (decimation 1) within 0.1%.
+template<uint32_t D>
+static RowingData<> runEncoder(const std::vector<uint32_t> &edges, double seconds, int loops,
+                               const RowingData<> *reference) {
+    RowingSettings<> settings;
+    const double binsPerMagnet = (double)ENCODER_SLOTS / (D * CONFIG_ORM_IMPULSES_PER_REV);
+    settings.numOfImpulsesPerRevolution = PhysicsScalar((double)ENCODER_SLOTS);
+    settings.impulseDecimation = D;
+    settings.minimumTimeBetweenImpulses = PhysicsScalar(static_cast<double>(settings.minimumTimeBetweenImpulses) / binsPerMagnet);
+    settings.maximumTimeBetweenImpulses = PhysicsScalar(static_cast<double>(settings.maximumTimeBetweenImpulses) / binsPerMagnet);
+    settings.updateDerived();
+
+    RowingEngine<PhysicsScalar, RowingSettings<>> engine(settings);
+    engine.setStrokeWorkQueue(nullptr);
+    engine.startSession();
+    ImpulseDecimator<D> decimator;
+
+    uint64_t bins = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < loops; loop++) {
+        for (uint32_t edge : edges) {
+            uint32_t binCycles;
+            if (decimator.push(edge, binCycles)) {
+                engine.handleRotationImpulse(binCycles);
+                bins++;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    double rowingSeconds = seconds * loops;
+    RowingData<> data = engine.getData();
+    const char *match = "";
+    if (reference != nullptr) {
+        auto close = [](double a, double b) { return std::fabs(a - b) <= 0.001 * std::fabs(b); };
+        bool same = data.strokeCount == reference->strokeCount &&
+                    close(static_cast<double>(data.distance), static_cast<double>(reference->distance)) &&
+                    close(static_cast<double>(data.dragFactor), static_cast<double>(reference->dragFactor));
+        match = same ? "match" : "MISMATCH";
+    }
+    printf("%-10u %8.0f %10.0f %12.0f %8.2f %8.1f %10.4f %8d %10.2f %10.3f   %s\n",
+           D, (double)ENCODER_SLOTS / D, edges.size() * loops / rowingSeconds, bins / rowingSeconds,
+           ns / ((double)edges.size() * loops), ns / (double)bins, 100.0 * ns / (rowingSeconds * 1e9),
+           data.strokeCount, static_cast<double>(data.distance), static_cast<double>(data.dragFactor) * 1e6, match);
+    return data;
+}
+
+// Flank detector alone: cost per impulse, drive/recovery flips and the
+// impulse-to-impulse jitter of the angular acceleration, the way the engine queries it
+template<typename D>
+static void runFlankDetector(const char *name, int loops) {
+    static PhysicsScalar replay[dtCount];
+    for (size_t i = 0; i < dtCount; i++) {
+        replay[i] = PhysicsScalar(dtValues[i]);
+    }
+
+    DefaultRowingSettings<> settings;
+    D detector(settings);
+    bool drive = false;
+    int drives = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < loops; loop++) {
+        for (size_t i = 0; i < dtCount; i++) {
+            // Same gate as RowingEngine::handleRotationImpulse()
+            if (replay[i] < settings.minimumTimeBetweenImpulses || replay[i] > settings.maximumImpulseTimeBeforePause) {
+                continue;
+            }
+            detector.pushValue(replay[i], replayCycles[i]);
+            if (drive ? detector.isFlywheelUnpowered() : detector.isFlywheelPowered()) {
+                drive = !drive;
+                if (drive) drives++;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // Untimed second replay of one loop for the acceleration jitter
+    D probe(settings);
+    double previous = 0.0;
+    double squares = 0.0;
+    int samples = 0;
+    for (size_t i = 0; i < dtCount; i++) {
+        if (replay[i] < settings.minimumTimeBetweenImpulses || replay[i] > settings.maximumImpulseTimeBeforePause) {
+            continue;
+        }
+        probe.pushValue(replay[i], replayCycles[i]);
+        double acceleration = static_cast<double>(probe.accelerationAtBeginOfFlank());
+        if (samples > 0) squares += (acceleration - previous) * (acceleration - previous);
+        previous = acceleration;
+        samples++;
+    }
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-15s %9.1f %8d %14.1f\n", name, ns / ((double)loops * dtCount), drives,
+           std::sqrt(squares / (samples > 1 ? samples - 1 : 1)));
+}
+
+static double drift(double value, double reference) {
+    if (reference == 0.0) return (value == 0.0) ? 0.0 : INFINITY;
+    return 100.0 * (value - reference) / reference;
+}
+
+int main(int argc, char **argv) {
+    int passes = (argc > 1) ? atoi(argv[1]) : 5;
+    int loops = (argc > 2) ? atoi(argv[2]) : 500;
+    if (passes < 1) passes = 1;
+    if (loops < 1) loops = 1;
+    convertReplay();
+
+    const BenchResult results[] = {
+        runReplay<double, RowingSettings<double>>("runtime", passes, loops),
+        runReplay<double, StaticRowingSettings<double>>("static", passes, loops),
+        runReplay<float, RowingSettings<float>>("runtime", passes, loops),
+        runReplay<float, StaticRowingSettings<float>>("static", passes, loops),
+        runReplay<Fixed, RowingSettings<Fixed>>("runtime", passes, loops),
+        runReplay<Fixed, StaticRowingSettings<Fixed>>("static", passes, loops),
+    };
+    const BenchResult &ref = results[0];
+
+    printf("=== orm_bench: %zu impulses x %d loops x %d passes (default: %s, %s flank detector) ===\n",
+           dtCount, loops, passes, PHYSICS_SCALAR_NAME, FLANK_DETECTOR_NAME);
+    printf("%-7s %-8s %9s %9s %8s %12s %12s %8s %10s %10s\n",
+           "type", "settings", "ns/mean", "ns/best", "strokes", "time [s]", "dist [m]", "SPM", "power [W]", "drag x1e6");
+    for (const BenchResult &r : results) {
+        printf("%-7s %-8s %9.1f %9.1f %8d %12.3f %12.2f %8.2f %10.2f %10.3f\n",
+               r.name, r.settings, r.meanNs, r.bestNs, r.strokes, r.totalTime, r.distance,
+               r.avgSpm, r.avgPower, r.dragFactor * 1e6);
+    }
+
+    printf("\nDrift against double [%%]:\n");
+    printf("%-7s %-8s %8s %12s %12s %8s %10s %10s\n",
+           "type", "settings", "strokes", "time", "dist", "SPM", "power", "drag");
+    for (const BenchResult &r : results) {
+        if (&r == &ref) continue;
+        printf("%-7s %-8s %8d %12.2e %12.2e %8.2e %10.2e %10.2e\n",
+               r.name, r.settings, r.strokes - ref.strokes,
+               drift(r.totalTime, ref.totalTime), drift(r.distance, ref.distance),
+               drift(r.avgSpm, ref.avgSpm), drift(r.avgPower, ref.avgPower),
+               drift(r.dragFactor, ref.dragFactor));
+    }
+
+    // The drag factor is learned in the unit of each model, starting from prj.conf
+    const BenchResult models[] = {
+        runReplay<PhysicsScalar, DefaultRowingSettings<>, AirRowerModel<>>("default", passes, loops),
+        runReplay<PhysicsScalar, DefaultRowingSettings<>, MagneticRowerModel<>>("default", passes, loops),
+        runReplay<PhysicsScalar, DefaultRowingSettings<>, WaterRowerModel<>>("default", passes, loops),
+    };
+    printf("\nRower models (%s):\n", PHYSICS_SCALAR_NAME);
+    printf("%-9s %9s %9s %8s %12s %8s %10s %10s\n",
+           "model", "ns/mean", "ns/best", "strokes", "dist [m]", "SPM", "power [W]", "drag x1e6");
+    for (const BenchResult &r : models) {
+        printf("%-9s %9.1f %9.1f %8d %12.2f %8.2f %10.2f %10.3f\n",
+               r.model, r.meanNs, r.bestNs, r.strokes, r.distance, r.avgSpm, r.avgPower, r.dragFactor * 1e6);
+    }
+
+    printf("\nFlank detectors alone (%s):\n", PHYSICS_SCALAR_NAME);
+    printf("%-15s %9s %8s %14s\n", "detector", "ns/mean", "drives", "accel jitter");
+    runFlankDetector<MovingFlankDetector<PhysicsScalar, DefaultRowingSettings<>, MovingAverageFilter<>>>("moving average", loops);
+    runFlankDetector<MovingFlankDetector<PhysicsScalar, DefaultRowingSettings<>, SavitzkyGolayFilter<>>>("savitzky-golay", loops);
+    runFlankDetector<RegressionFlankDetector<>>("regression", loops);
+    runFlankDetector<KalmanFlankDetector<>>("kalman", loops);
+
+    runContention(loops);
+
+    printf("\nPer-impulse latency (%s), stroke stage inline vs. on the work queue [ns]:\n", PHYSICS_SCALAR_NAME);
+    printf("%-9s %9s %9s %9s %8s %10s %8s %8s\n",
+           "stage 2", "mean", "p99.9", "max", "strokes", "dist [m]", "records", "dropped");
+    runLatency(loops, false);
+    runLatency(loops, true);
+
+    // Host CPU and engine calls only: no ISR, no queues, no Bluetooth. The
+    // board figures come from CONFIG_GPIO_ENABLE_PHYSICS_PROFILING.
+    printf("\nRowers on one physics thread (%s), host-only, ISR not included:\n", PHYSICS_SCALAR_NAME);
+    printf("%-7s %9s %12s %10s %12s %10s %8s\n",
+           "rowers", "ns/mean", "impulses/s", "load [%]", "budget [us]", "headroom", "strokes");
+    runMultiRower(1, loops);
+    runMultiRower(2, loops);
+    runMultiRower(4, loops);
+
+    printf("\nStroke history and quality (%s), last %d strokes:\n", PHYSICS_SCALAR_NAME, CONFIG_ORM_STROKE_HISTORY_LENGTH);
+    runHistory(loops);
+
+    printf("\nWorkout 2x1000 m, 2x2:00, 2x40 strokes, no rest (%s):\n", PHYSICS_SCALAR_NAME);
+    printf("%-9s %10s %10s %8s %10s %10s %8s\n", "interval", "time [s]", "dist [m]", "strokes", "pace [s]", "power [W]", "SPM");
+    runWorkout(loops);
+
+    printf("\nPause after every loop (%s), against the same replay without:\n", PHYSICS_SCALAR_NAME);
+    printf("%-10s %12s %8s %12s %10s %8s\n", "pauses", "time [s]", "strokes", "dist [m]", "paused W", "SPM");
+    runPause(loops);
+
+    printf("\nRuntime settings (%s), through a SettingsStore: ", PHYSICS_SCALAR_NAME);
+    runSettings(loops);
+
+    printf("\nWarm start (%s): ", PHYSICS_SCALAR_NAME);
+    runWarmStart(loops);
+
+    printf("\nImpulse queue overflow (%s): ", PHYSICS_SCALAR_NAME);
+    runOverflow(loops);
+
+    double encoderSeconds = 0.0;
+    std::vector<uint32_t> edges = synthesizeEncoder(encoderSeconds);
+    uint32_t fastestEdge = *std::min_element(edges.begin(), edges.end());
+    printf("\nEncoder, %d slots (%s): %.0f edges/s mean, %.0f peak\n", ENCODER_SLOTS, PHYSICS_SCALAR_NAME,
+           edges.size() / encoderSeconds, (double)sys_clock_hw_cycles_per_sec() / fastestEdge);
+    printf("%-10s %8s %10s %12s %8s %8s %10s %8s %10s %10s\n",
+           "decimation", "bins/rev", "edges/s", "engine/s", "ns/edge", "ns/bin", "load [%]", "strokes", "dist [m]", "drag x1e6");
+    RowingData<> fullResolution = runEncoder<1>(edges, encoderSeconds, loops, nullptr);
+    runEncoder<8>(edges, encoderSeconds, loops, &fullResolution);
+    runEncoder<80>(edges, encoderSeconds, loops, &fullResolution);
+    runEncoder<320>(edges, encoderSeconds, loops, &fullResolution);
+    return 0;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * @brief Kconfig fallback values for the host build.
+ *
+ * host/CMakeLists.txt turns every CONFIG_ORM_* line of prj.conf into a
+ * compile definition. Anything prj.conf leaves unset falls back to the
+ * Kconfig default below, mirroring what autoconf.h would contain.
+ */
+
+// Host clock: same rate as the ESP32-S3 systimer behind k_cycle_get_32().
+#ifndef CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC
+#define CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC 16000000
+#endif
+
+// modules/rowing_core/RowingSettings/Kconfig
+#ifndef CONFIG_ORM_IMPULSES_PER_REV
+#define CONFIG_ORM_IMPULSES_PER_REV 1
+#endif
+#ifndef CONFIG_ORM_IMPULSE_DECIMATION
+#define CONFIG_ORM_IMPULSE_DECIMATION 1
+#endif
+#ifndef CONFIG_ORM_ANALYSIS_STEPS_PER_REV
+#define CONFIG_ORM_ANALYSIS_STEPS_PER_REV CONFIG_ORM_IMPULSES_PER_REV
+#endif
+#ifndef CONFIG_ORM_ROWER_COUNT
+#define CONFIG_ORM_ROWER_COUNT 1
+#endif
+#ifndef CONFIG_ORM_MIN_TIME_BETWEEN_IMPULSE_X10000
+#define CONFIG_ORM_MIN_TIME_BETWEEN_IMPULSE_X10000 140
+#endif
+#ifndef CONFIG_ORM_MAX_TIME_BETWEEN_IMPULSE_X10000
+#define CONFIG_ORM_MAX_TIME_BETWEEN_IMPULSE_X10000 35000
+#endif
+#ifndef CONFIG_ORM_MAXIMUM_DOWNWARD_CHANGE_X10000
+#define CONFIG_ORM_MAXIMUM_DOWNWARD_CHANGE_X10000 2500
+#endif
+#ifndef CONFIG_ORM_MAXIMUM_UPWARD_CHANGE_X10000
+#define CONFIG_ORM_MAXIMUM_UPWARD_CHANGE_X10000 17500
+#endif
+#ifndef CONFIG_ORM_SMOOTHING
+#define CONFIG_ORM_SMOOTHING 4
+#endif
+#ifndef CONFIG_ORM_SG_WINDOW
+#define CONFIG_ORM_SG_WINDOW 7
+#endif
+#ifndef CONFIG_ORM_SG_ORDER
+#define CONFIG_ORM_SG_ORDER 1
+#endif
+#ifndef CONFIG_ORM_SG_DELAY
+#define CONFIG_ORM_SG_DELAY 3
+#endif
+#ifndef CONFIG_ORM_KALMAN_JERK_NOISE
+#define CONFIG_ORM_KALMAN_JERK_NOISE 20000
+#endif
+#ifndef CONFIG_ORM_KALMAN_ANGLE_NOISE_X10000
+#define CONFIG_ORM_KALMAN_ANGLE_NOISE_X10000 300
+#endif
+#ifndef CONFIG_ORM_KALMAN_GATE
+#define CONFIG_ORM_KALMAN_GATE 5
+#endif
+#ifndef CONFIG_ORM_FLANK_LENGTH
+#define CONFIG_ORM_FLANK_LENGTH 4
+#endif
+#ifndef CONFIG_ORM_NUM_OF_ERRORS_ALLOWED
+#define CONFIG_ORM_NUM_OF_ERRORS_ALLOWED 0
+#endif
+#ifndef CONFIG_ORM_NATURAL_DECELARATION_X10000
+#define CONFIG_ORM_NATURAL_DECELARATION_X10000 0
+#endif
+#ifndef CONFIG_ORM_MAX_IMPULSE_TIME_BEFORE_PAUSE_X10000
+#define CONFIG_ORM_MAX_IMPULSE_TIME_BEFORE_PAUSE_X10000 30000
+#endif
+#ifndef CONFIG_ORM_MIN_DRIVE_TIME_X10000
+#define CONFIG_ORM_MIN_DRIVE_TIME_X10000 3000
+#endif
+#ifndef CONFIG_ORM_MIN_RECOVERY_TIME_X10000
+#define CONFIG_ORM_MIN_RECOVERY_TIME_X10000 12000
+#endif
+#ifndef CONFIG_ORM_FLYWHEEL_INERTIA_X10000
+#define CONFIG_ORM_FLYWHEEL_INERTIA_X10000 5000
+#endif
+#ifdef CONFIG_ORM_AUTO_ADJUST_DRAG_FACTOR
+#ifndef CONFIG_ORM_DAMPING_CONSTANT_SMOOTING
+#define CONFIG_ORM_DAMPING_CONSTANT_SMOOTING 5
+#endif
+#ifndef CONFIG_ORM_DAMPING_CONSTANT_MAX_CHANGE_X10000
+#define CONFIG_ORM_DAMPING_CONSTANT_MAX_CHANGE_X10000 1000
+#endif
+#endif
+#ifndef CONFIG_ORM_WARM_START_SAVE_INTERVAL_S
+#define CONFIG_ORM_WARM_START_SAVE_INTERVAL_S 300
+#endif
+#ifndef CONFIG_ORM_WARM_START_MIN_CHANGE_PERMILLE
+#define CONFIG_ORM_WARM_START_MIN_CHANGE_PERMILLE 5
+#endif
+#ifndef CONFIG_ORM_STROKE_QUEUE_LENGTH
+#define CONFIG_ORM_STROKE_QUEUE_LENGTH 8
+#endif
+#ifndef CONFIG_ORM_HUMAN_EFFICIENCY_PERCENT
+#define CONFIG_ORM_HUMAN_EFFICIENCY_PERCENT 25
+#endif
+#ifndef CONFIG_ORM_BASAL_ENERGY_KCAL_PER_HOUR
+#define CONFIG_ORM_BASAL_ENERGY_KCAL_PER_HOUR 300
+#endif
+#ifndef CONFIG_ORM_STROKE_HISTORY_LENGTH
+#define CONFIG_ORM_STROKE_HISTORY_LENGTH 64
+#endif
+#ifndef CONFIG_ORM_RECENT_STROKE_COUNT
+#define CONFIG_ORM_RECENT_STROKE_COUNT 4
+#endif
+#ifndef CONFIG_ORM_WORKOUT_MAX_INTERVALS
+#define CONFIG_ORM_WORKOUT_MAX_INTERVALS 16
+#endif
+#ifndef CONFIG_ORM_STROKE_WORKQ_STACK_SIZE
+#define CONFIG_ORM_STROKE_WORKQ_STACK_SIZE 2048
+#endif
+#ifndef CONFIG_ORM_STROKE_WORKQ_PRIORITY
+#define CONFIG_ORM_STROKE_WORKQ_PRIORITY 7
+#endif
+#ifndef CONFIG_ORM_DRAG_FACTOR
+#define CONFIG_ORM_DRAG_FACTOR 1500
+#endif
+#ifndef CONFIG_ORM_MAGIC_CONSTANT_X10000
+#define CONFIG_ORM_MAGIC_CONSTANT_X10000 2800
+#endif
@@ -0,0 +1,256 @@
+#pragma once
+
+/**
+ * @brief Minimal stand-in for <zephyr/kernel.h> used by the host build.
+ *
+ * Only the kernel services the physics engine touches are provided:
+ * mutexes, work queues, delayable work, uptime, cycle counter, sleep and printk. Everything maps onto the
+ * C++ standard library so the engine can run (and be profiled) on Linux.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "orm_host_config.h"
+
+// -----------------------------------------------------------------------------
+// Utility macros (zephyr/sys/util.h)
+// -----------------------------------------------------------------------------
+#ifndef BIT
+#define BIT(n) (1UL << (n))
+#endif
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#endif
+
+#ifndef ARG_UNUSED
+#define ARG_UNUSED(x) (void)(x)
+#endif
+
+// IS_ENABLED(CONFIG_FOO) evaluates to 1 if CONFIG_FOO is defined to 1, else 0.
+// Same preprocessor trick as upstream Zephyr.
+#define Z_IS_ENABLED_XXXX1 Z_IS_ENABLED_YYYY,
+#define IS_ENABLED(config_macro) Z_IS_ENABLED1(config_macro)
+#define Z_IS_ENABLED1(config_macro) Z_IS_ENABLED2(Z_IS_ENABLED_XXXX##config_macro)
+#define Z_IS_ENABLED2(one_or_two_args) Z_IS_ENABLED3(one_or_two_args 1, 0)
+#define Z_IS_ENABLED3(ignore_this, val, ...) val
+
+#ifndef CONTAINER_OF
+#define CONTAINER_OF(ptr, type, field) \
+    ((type *)(((char *)(ptr)) - offsetof(type, field)))
+#endif
+
+#define printk(...) printf(__VA_ARGS__)
+#define snprintk(...) snprintf(__VA_ARGS__)
+
+// -----------------------------------------------------------------------------
+// Timeouts
+// -----------------------------------------------------------------------------
+typedef struct {
+    int64_t ms;
+} k_timeout_t;
+
+#define K_FOREVER (k_timeout_t{-1})
+#define K_NO_WAIT (k_timeout_t{0})
+#define K_MSEC(ms) (k_timeout_t{(int64_t)(ms)})
+#define K_SECONDS(s) K_MSEC((int64_t)(s) * 1000)
+
+// -----------------------------------------------------------------------------
+// Mutex (Zephyr mutexes are recursive for the owning thread)
+// -----------------------------------------------------------------------------
+struct k_mutex {
+    std::recursive_timed_mutex impl;
+};
+
+static inline int k_mutex_init(struct k_mutex *mutex) {
+    (void)mutex;
+    return 0;
+}
+
+static inline int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout) {
+    if (timeout.ms < 0) {
+        mutex->impl.lock();
+        return 0;
+    }
+    return mutex->impl.try_lock_for(std::chrono::milliseconds(timeout.ms)) ? 0 : -EAGAIN;
+}
+
+static inline int k_mutex_unlock(struct k_mutex *mutex) {
+    mutex->impl.unlock();
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Time
+// -----------------------------------------------------------------------------
+static inline std::chrono::steady_clock::time_point z_host_boot_time() {
+    static const std::chrono::steady_clock::time_point boot = std::chrono::steady_clock::now();
+    return boot;
+}
+
+static inline int64_t k_uptime_get() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - z_host_boot_time()).count();
+}
+
+static inline uint32_t k_uptime_get_32() {
+    return (uint32_t)k_uptime_get();
+}
+
+static inline uint32_t sys_clock_hw_cycles_per_sec() {
+    return CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
+}
+
+static inline uint64_t k_cycle_get_64() {
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - z_host_boot_time()).count();
+    return (uint64_t)((double)ns * ((double)CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC / 1e9));
+}
+
+static inline uint32_t k_cycle_get_32() {
+    return (uint32_t)k_cycle_get_64();
+}
+
+static inline int32_t k_msleep(int32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Work queues (one std::thread per queue; priorities are ignored)
+// -----------------------------------------------------------------------------
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+
+// Work queues run until the process exits, so the state they share with their
+// detached thread is never destroyed (a static condition variable with a
+// waiter would block the exit).
+struct k_work_q_state {
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<struct k_work *> items;
+};
+
+struct k_work_q {
+    struct k_work_q_state *state;
+};
+
+struct k_work {
+    k_work_handler_t handler;
+    struct k_work_q *queue;
+    bool queued;
+    bool running;
+};
+
+struct k_work_sync {
+};
+
+struct k_work_queue_config {
+    const char *name;
+    bool no_yield;
+    bool essential;
+};
+
+typedef char k_thread_stack_t;
+#define K_THREAD_STACK_DEFINE(sym, size) k_thread_stack_t sym[size]
+#define K_THREAD_STACK_SIZEOF(sym) sizeof(sym)
+
+static inline void k_work_init(struct k_work *work, k_work_handler_t handler) {
+    work->handler = handler;
+    work->queue = nullptr;
+    work->queued = false;
+    work->running = false;
+}
+
+static inline void k_work_queue_init(struct k_work_q *queue) {
+    queue->state = new k_work_q_state();
+}
+
+static inline void k_work_queue_start(struct k_work_q *queue, k_thread_stack_t *stack, size_t stack_size,
+                                      int prio, const struct k_work_queue_config *cfg) {
+    (void)stack; (void)stack_size; (void)prio; (void)cfg;
+    struct k_work_q_state *q = queue->state;
+    std::thread([q]() {
+        std::unique_lock<std::mutex> guard(q->lock);
+        while (true) {
+            q->changed.wait(guard, [q]() { return !q->items.empty(); });
+            struct k_work *work = q->items.front();
+            q->items.pop_front();
+            work->queued = false;
+            work->running = true;
+            guard.unlock();
+            work->handler(work);
+            guard.lock();
+            work->running = false;
+            q->changed.notify_all();
+        }
+    }).detach();
+}
+
+static inline int k_work_submit_to_queue(struct k_work_q *queue, struct k_work *work) {
+    struct k_work_q_state *q = queue->state;
+    std::lock_guard<std::mutex> guard(q->lock);
+    if (work->queued) {
+        return 0;
+    }
+    work->queue = queue;
+    work->queued = true;
+    q->items.push_back(work);
+    q->changed.notify_all();
+    return work->running ? 2 : 1;
+}
+
+static inline bool k_work_flush(struct k_work *work, struct k_work_sync *sync) {
+    (void)sync;
+    struct k_work_q *queue = work->queue;
+    if (queue == nullptr) {
+        return false;
+    }
+    struct k_work_q_state *q = queue->state;
+    std::unique_lock<std::mutex> guard(q->lock);
+    bool busy = work->queued || work->running;
+    q->changed.wait(guard, [work]() { return !work->queued && !work->running; });
+    return busy;
+}
+
+// -----------------------------------------------------------------------------
+// Delayable work on the system work queue. The host has no system work
+// queue: work due now runs on the caller, a later deadline is only kept
+// (nothing waits for it, a bench does not run for the interval).
+// -----------------------------------------------------------------------------
+struct k_work_delayable {
+    struct k_work work;
+    bool pending;
+    int64_t delayMs;
+};
+
+static inline void k_work_init_delayable(struct k_work_delayable *dwork, k_work_handler_t handler) {
+    k_work_init(&dwork->work, handler);
+    dwork->pending = false;
+    dwork->delayMs = 0;
+}
+
+static inline int k_work_reschedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    if (delay.ms != 0) {
+        dwork->pending = true;
+        dwork->delayMs = delay.ms;
+        return 1;
+    }
+    dwork->pending = false;
+    dwork->work.running = true;
+    dwork->work.handler(&dwork->work);
+    dwork->work.running = false;
+    return 1;
+}
+
+static inline int k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay) {
+    return dwork->pending ? 0 : k_work_reschedule(dwork, delay);
+}
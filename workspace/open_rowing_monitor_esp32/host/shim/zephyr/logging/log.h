@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @brief Minimal stand-in for <zephyr/logging/log.h> used by the host build.
+ *
+ * LOG_MODULE_REGISTER keeps its per-module level, and ORM_HOST_LOG_LEVEL caps
+ * everything globally so benchmark runs are not dominated by printf.
+ */
+
+#include <cstdio>
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERR  1
+#define LOG_LEVEL_WRN  2
+#define LOG_LEVEL_INF  3
+#define LOG_LEVEL_DBG  4
+
+#ifndef ORM_HOST_LOG_LEVEL
+#define ORM_HOST_LOG_LEVEL LOG_LEVEL_WRN
+#endif
+
+#define LOG_MODULE_REGISTER(name, level)                          \
+    static constexpr const char *z_host_log_module_name = #name;  \
+    static constexpr int z_host_log_module_level = (level)
+
+#define Z_HOST_LOG(lvl, tag, fmt, ...)                                              \
+    do {                                                                            \
+        if ((lvl) <= z_host_log_module_level && (lvl) <= ORM_HOST_LOG_LEVEL) {      \
+            fprintf(stderr, "<" tag "> %s: " fmt "\n", z_host_log_module_name,      \
+                    ##__VA_ARGS__);                                                 \
+        }                                                                           \
+    } while (0)
+
+#define LOG_ERR(...) Z_HOST_LOG(LOG_LEVEL_ERR, "err", __VA_ARGS__)
+#define LOG_WRN(...) Z_HOST_LOG(LOG_LEVEL_WRN, "wrn", __VA_ARGS__)
+#define LOG_INF(...) Z_HOST_LOG(LOG_LEVEL_INF, "inf", __VA_ARGS__)
+#define LOG_DBG(...) Z_HOST_LOG(LOG_LEVEL_DBG, "dbg", __VA_ARGS__)
@@ -0,0 +1,62 @@
+#pragma once
+
+/**
+ * @brief Minimal stand-in for <zephyr/settings/settings.h> used by the host build.
+ *
+ * The "flash" is a key/value map of the process: it outlives the engines
+ * and a WarmStart, so a bench reboots by building new engines and
+ * loading them again, the way NVS outlives a reset. Only the direct
+ * load and save_one calls of WarmStart are provided.
+ */
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+typedef ssize_t (*settings_read_cb)(void *cb_arg, void *data, size_t len);
+typedef int (*settings_load_direct_cb)(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg,
+                                       void *param);
+
+// inline, not static: one flash for every translation unit
+inline std::map<std::string, std::vector<uint8_t>> &z_host_settings_flash() {
+    static std::map<std::string, std::vector<uint8_t>> flash;
+    return flash;
+}
+
+// Writes since the process started, the flash wear a bench reports
+inline int &z_host_settings_writes() {
+    static int writes = 0;
+    return writes;
+}
+
+static inline int settings_subsys_init(void) {
+    return 0;
+}
+
+static inline int settings_save_one(const char *name, const void *value, size_t val_len) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(value);
+    z_host_settings_flash()[name] = std::vector<uint8_t>(bytes, bytes + val_len);
+    z_host_settings_writes()++;
+    return 0;
+}
+
+static inline ssize_t z_host_settings_read(void *cb_arg, void *data, size_t len) {
+    const std::vector<uint8_t> *value = static_cast<const std::vector<uint8_t> *>(cb_arg);
+    size_t n = (len < value->size()) ? len : value->size();
+    memcpy(data, value->data(), n);
+    return (ssize_t)n;
+}
+
+// Every key below subtree, named relative to it
+static inline int settings_load_subtree_direct(const char *subtree, settings_load_direct_cb cb, void *param) {
+    std::string prefix = std::string(subtree) + "/";
+    for (auto &entry : z_host_settings_flash()) {
+        if (entry.first.compare(0, prefix.size(), prefix) != 0) continue;
+        int err = cb(entry.first.c_str() + prefix.size(), entry.second.size(), z_host_settings_read,
+                     &entry.second, param);
+        if (err != 0) return err;
+    }
+    return 0;
+}
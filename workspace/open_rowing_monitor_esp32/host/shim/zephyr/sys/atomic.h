@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * @brief Minimal stand-in for <zephyr/sys/atomic.h> used by the host build.
+ *
+ * Same signatures as upstream (atomic_t is a long, every operation is
+ * sequentially consistent), implemented with the GCC/Clang __atomic builtins.
+ */
+
+typedef long atomic_t;
+typedef atomic_t atomic_val_t;
+
+#define ATOMIC_INIT(i) (i)
+
+static inline atomic_val_t atomic_get(const atomic_t *target) {
+    return __atomic_load_n(target, __ATOMIC_SEQ_CST);
+}
+
+static inline atomic_val_t atomic_set(atomic_t *target, atomic_val_t value) {
+    return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+static inline atomic_val_t atomic_inc(atomic_t *target) {
+    return __atomic_fetch_add(target, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline atomic_val_t atomic_add(atomic_t *target, atomic_val_t value) {
+    return __atomic_fetch_add(target, value, __ATOMIC_SEQ_CST);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+/**
+ * @brief Minimal stand-in for <zephyr/sys/barrier.h> used by the host build.
+ */
+
+static inline void barrier_dmem_fence_full(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
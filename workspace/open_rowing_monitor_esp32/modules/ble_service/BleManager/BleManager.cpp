@@ -1,8 +1,13 @@
 #include "BleManager.h"
 #include "FTMS.h" // To get UUID definitions
+#ifdef CONFIG_BT_SETTINGS
+#include <zephyr/settings/settings.h>
+#endif
 
 struct bt_conn *BleManager::current_conns[CONFIG_BT_MAX_CONN] = {nullptr};
+int BleManager::conn_rower[CONFIG_BT_MAX_CONN] = {0};
 int BleManager::active_connections = 0;
+int BleManager::rower_connections[CONFIG_ORM_ROWER_COUNT] = {0};
 struct k_event *BleManager::state_change_event = nullptr;
 
 LOG_MODULE_REGISTER(BleManager, LOG_LEVEL_INF);
@@ -32,6 +37,66 @@ static const struct bt_data sd[] = {
     BT_DATA(BT_DATA_NAME_COMPLETE, CONFIG_BT_DEVICE_NAME, sizeof(CONFIG_BT_DEVICE_NAME) - 1),
 };
 
+#if CONFIG_ORM_ROWER_COUNT > 1
+BUILD_ASSERT(IS_ENABLED(CONFIG_BT_EXT_ADV), "CONFIG_ORM_ROWER_COUNT > 1 needs CONFIG_BT_EXT_ADV=y");
+BUILD_ASSERT(CONFIG_BT_ID_MAX >= CONFIG_ORM_ROWER_COUNT, "CONFIG_BT_ID_MAX must cover every rower");
+#ifdef CONFIG_BT_EXT_ADV
+BUILD_ASSERT(CONFIG_BT_EXT_ADV_MAX_ADV_SET >= CONFIG_ORM_ROWER_COUNT, "CONFIG_BT_EXT_ADV_MAX_ADV_SET must cover every rower");
+#endif
+
+uint8_t BleManager::rower_identity[CONFIG_ORM_ROWER_COUNT] = {BT_ID_DEFAULT};
+struct bt_le_ext_adv *BleManager::rower_adv[CONFIG_ORM_ROWER_COUNT] = {nullptr};
+
+// Per rower scan response: the device name with the rower number, "Rowing-Monitor-2"
+static char rower_name[CONFIG_ORM_ROWER_COUNT][sizeof(CONFIG_BT_DEVICE_NAME) + 4];
+static struct bt_data rower_sd[CONFIG_ORM_ROWER_COUNT][1];
+
+int BleManager::createRowerAdvertisers() {
+    // Identities stored by an earlier boot (CONFIG_BT_SETTINGS) keep their
+    // address, so the apps see the same rower devices after a power cycle
+    size_t identities = CONFIG_BT_ID_MAX;
+    bt_id_get(NULL, &identities);
+
+    for (int rower = 0; rower < CONFIG_ORM_ROWER_COUNT; rower++) {
+        if (rower > 0 && (size_t)rower < identities) {
+            rower_identity[rower] = (uint8_t)rower;
+        } else if (rower > 0) {
+            int id = bt_id_create(NULL, NULL);
+            if (id < 0) {
+                LOG_ERR("Identity for rower %d failed (err %d)", rower, id);
+                return id;
+            }
+            rower_identity[rower] = (uint8_t)id;
+        }
+
+        struct bt_le_adv_param param = BT_LE_ADV_PARAM_INIT(
+            BT_LE_ADV_OPT_CONN,
+            BT_GAP_ADV_FAST_INT_MIN_2,
+            BT_GAP_ADV_FAST_INT_MAX_2,
+            NULL);
+        param.id = rower_identity[rower];
+
+        int err = bt_le_ext_adv_create(&param, NULL, &rower_adv[rower]);
+        if (err) {
+            LOG_ERR("Advertising set for rower %d failed (err %d)", rower, err);
+            return err;
+        }
+
+        int len = snprintk(rower_name[rower], sizeof(rower_name[rower]), "%s-%d", CONFIG_BT_DEVICE_NAME, rower + 1);
+        rower_sd[rower][0].type = BT_DATA_NAME_COMPLETE;
+        rower_sd[rower][0].data_len = (uint8_t)len;
+        rower_sd[rower][0].data = (const uint8_t *)rower_name[rower];
+        err = bt_le_ext_adv_set_data(rower_adv[rower], ad, ARRAY_SIZE(ad), rower_sd[rower], ARRAY_SIZE(rower_sd[rower]));
+        if (err) {
+            LOG_ERR("Advertising data for rower %d failed (err %d)", rower, err);
+            return err;
+        }
+        LOG_INF("Rower %d advertises as %s (identity %u)", rower, rower_name[rower], rower_identity[rower]);
+    }
+    return 0;
+}
+#endif
+
 void BleManager::init(struct k_event* main_event_group) {
     int err = bt_enable(NULL);
     if (err) {
@@ -41,6 +106,17 @@ void BleManager::init(struct k_event* main_event_group) {
     LOG_INF("Bluetooth Initialized");
     active_connections = 0;
 
+#ifdef CONFIG_BT_SETTINGS
+    // Loads the identities and bonds before the advertisers use them
+    settings_load();
+#endif
+
+#if CONFIG_ORM_ROWER_COUNT > 1
+    if (createRowerAdvertisers() != 0) {
+        return;
+    }
+#endif
+
     if (main_event_group == nullptr) {
         LOG_ERR("Event was not registered");
         return;
@@ -59,6 +135,21 @@ void BleManager::startAdvertising() {
     int conn_count = active_connections;
     k_mutex_unlock(&conn_mutex);
 
+#if CONFIG_ORM_ROWER_COUNT > 1
+    // The set an app connected to has stopped; the others keep going until
+    // the connections run out
+    for (int rower = 0; rower < CONFIG_ORM_ROWER_COUNT; rower++) {
+        int err = (conn_count >= CONFIG_BT_MAX_CONN)
+            ? bt_le_ext_adv_stop(rower_adv[rower])
+            : bt_le_ext_adv_start(rower_adv[rower], BT_LE_EXT_ADV_START_DEFAULT);
+        if (err && err != -EALREADY) {
+            LOG_ERR("Advertising of rower %d failed (err %d)", rower, err);
+        }
+    }
+    if (conn_count >= CONFIG_BT_MAX_CONN) {
+        LOG_DBG("Max connections reached, not advertising");
+    }
+#else
     if (conn_count >= CONFIG_BT_MAX_CONN) {
         LOG_DBG("Max connections reached, not advertising");
         return;
@@ -78,34 +169,50 @@ void BleManager::startAdvertising() {
     } else {
         LOG_ERR("Advertising failed to start (err %d)", err);
     }
+#endif
 }
 
-bool BleManager::isConnected() {
+bool BleManager::isConnected(int rower) {
     k_mutex_lock(&conn_mutex, K_FOREVER);
-    bool connected = (active_connections > 0);
+    bool connected = (rower_connections[rower] > 0);
     k_mutex_unlock(&conn_mutex);
     return connected;
 }
 
+int BleManager::rowerOf(struct bt_conn *conn) {
+#if CONFIG_ORM_ROWER_COUNT > 1
+    struct bt_conn_info info;
+    if (bt_conn_get_info(conn, &info) == 0) {
+        for (int rower = 0; rower < CONFIG_ORM_ROWER_COUNT; rower++) {
+            if (rower_identity[rower] == info.id) return rower;
+        }
+    }
+#endif
+    return 0;
+}
+
 void BleManager::onConnected(struct bt_conn *conn, uint8_t err) {
     if (err) {
         LOG_ERR("Connection failed (err 0x%02x)", err);
         return;
     }
 
+    int rower = rowerOf(conn);
     k_mutex_lock(&conn_mutex, K_FOREVER);
 
     bool slot_found = false;
     for (int i = 0; i < CONFIG_BT_MAX_CONN; i++) {
         if (current_conns[i] == nullptr) {
             current_conns[i] = bt_conn_ref(conn);
-            if(active_connections == 0 && state_change_event != nullptr) {
-                LOG_INF("First connection");
-                k_event_post(state_change_event, BIT(0));
+            conn_rower[i] = rower;
+            if(rower_connections[rower] == 0 && state_change_event != nullptr) {
+                LOG_INF("First connection to rower %d", rower);
+                k_event_post(state_change_event, BLE_CONNECTED_EVENT(rower));
             }
+            rower_connections[rower]++;
             active_connections++;
             slot_found = true;
-            LOG_INF("Connected (Slot %d, Total %d)", i, active_connections);
+            LOG_INF("Connected (Slot %d, Rower %d, Total %d)", i, rower, active_connections);
             break;
         }
     }
@@ -122,7 +229,8 @@ void BleManager::onConnected(struct bt_conn *conn, uint8_t err) {
 
     // Use work queue ONLY for reconnecting after a connection
     // This prevents race conditions with the BLE stack
-    if (current_conn_count < CONFIG_BT_MAX_CONN) {
+    // (several rowers: also to stop the other sets at the limit)
+    if (current_conn_count < CONFIG_BT_MAX_CONN || CONFIG_ORM_ROWER_COUNT > 1) {
         // Cancel any pending restart work first
         k_work_cancel_delayable(&adv_restart_work);
         // Schedule restart after 200ms to let connection stabilize
@@ -136,14 +244,17 @@ void BleManager::onDisconnected(struct bt_conn *conn, uint8_t reason) {
     k_mutex_lock(&conn_mutex, K_FOREVER);
     for (int i = 0; i < CONFIG_BT_MAX_CONN; i++) {
         if (current_conns[i] == conn) {
+            int rower = conn_rower[i];
             bt_conn_unref(current_conns[i]);
             current_conns[i] = nullptr;
             active_connections--;
-            if(active_connections == 0 && state_change_event != nullptr) {
-                LOG_INF("Last connection lost");
-                k_event_post(state_change_event, BIT(1));
+            rower_connections[rower]--;
+            if(rower_connections[rower] == 0 && state_change_event != nullptr) {
+                LOG_INF("Last connection to rower %d lost", rower);
+                k_event_post(state_change_event, BLE_DISCONNECTED_EVENT(rower));
             }
             if (active_connections < 0) active_connections = 0;
+            if (rower_connections[rower] < 0) rower_connections[rower] = 0;
             LOG_INF("Slot %d freed, Total %d", i, active_connections);
             break;
         }
@@ -161,6 +272,7 @@ void BleManager::onDisconnected(struct bt_conn *conn, uint8_t reason) {
 void BleManager::advRestartHandler(struct k_work *work) {
     LOG_DBG("Work handler: Restarting advertising");
 
+#if CONFIG_ORM_ROWER_COUNT == 1
     // Stop any existing advertising first
     int err = bt_le_adv_stop();
     if (err && err != -EALREADY) {
@@ -169,19 +281,20 @@ void BleManager::advRestartHandler(struct k_work *work) {
 
     // Small delay to ensure clean state
     k_msleep(10);
+#endif
 
     // Restart advertising
     startAdvertising();
 }
 
-void BleManager::forEachConnection(void (*func)(struct bt_conn *conn, void *ptr), void *user_data) {
+void BleManager::forEachConnection(int rower, void (*func)(struct bt_conn *conn, void *ptr), void *user_data) {
     struct bt_conn *safe_conns[CONFIG_BT_MAX_CONN];
     int count = 0;
 
     // Prevents lock out because of the MUTEX
     k_mutex_lock(&conn_mutex, K_FOREVER);
     for (int i = 0; i < CONFIG_BT_MAX_CONN; i++) {
-        if (current_conns[i]) {
+        if (current_conns[i] && conn_rower[i] == rower) {
             safe_conns[count++] = bt_conn_ref(current_conns[i]);
         }
     }
@@ -8,25 +8,44 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/kernel.h>
 
+// Main loop events, one pair per rower: first app connected, last one gone
+#define BLE_CONNECTED_EVENT(rower)      BIT(2 * (rower))
+#define BLE_DISCONNECTED_EVENT(rower)   BIT(2 * (rower) + 1)
+
+/**
+ * Every rower is its own FTMS device: rower 0 advertises from the default
+ * Bluetooth identity, rower N (CONFIG_ORM_ROWER_COUNT > 1) from identity N
+ * with its own advertising set and name. A connection belongs to the rower
+ * whose identity it was made to.
+ */
 class BleManager {
 public:
     void init(struct k_event* main_event_group);
     static void startAdvertising();
 
-    // Check if a device is currently connected
-    bool isConnected();
+    // Check if a device is currently connected to the rower
+    bool isConnected(int rower);
+    // Rower the connection was made to
+    static int rowerOf(struct bt_conn *conn);
 
     static void onConnected(struct bt_conn *conn, uint8_t err);
     static void onDisconnected(struct bt_conn *conn, uint8_t reason);
-    void forEachConnection(void (*func)(struct bt_conn *conn, void *data), void *user_data);
+    void forEachConnection(int rower, void (*func)(struct bt_conn *conn, void *data), void *user_data);
 private:
     // Track the active connection
     static struct bt_conn *current_conns[CONFIG_BT_MAX_CONN];
+    static int conn_rower[CONFIG_BT_MAX_CONN];
     static struct k_mutex conn_mutex;
     static int active_connections;
+    static int rower_connections[CONFIG_ORM_ROWER_COUNT];
     static struct k_event *state_change_event;
     static struct k_work_delayable adv_restart_work;
     static void advRestartHandler(struct k_work *work);
+#if CONFIG_ORM_ROWER_COUNT > 1
+    static uint8_t rower_identity[CONFIG_ORM_ROWER_COUNT];
+    static struct bt_le_ext_adv *rower_adv[CONFIG_ORM_ROWER_COUNT];
+    static int createRowerAdvertisers();
+#endif
 };
 
 #endif // BLE_MANAGER_H
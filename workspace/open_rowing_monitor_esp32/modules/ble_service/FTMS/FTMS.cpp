@@ -8,7 +8,16 @@ LOG_MODULE_REGISTER(FTMS, LOG_LEVEL_INF);
 
 // FTMS Features: Read-only.
 // Bit 4 = Rower Supported.
-static const uint32_t ftms_feature = 0x0000082D | BIT(4);
+// Bit 9 = Expended Energy Supported.
+static const uint32_t ftms_feature = 0x0000082D | BIT(4) | BIT(9);
+
+// Rower Data field sizes, in the order notifyRowingData() writes them.
+// A default ATT MTU (23) carries 20 bytes: enough without energy.
+#define ROWER_DATA_BASE_SIZE (2 /* flags */ + 1 + 2 /* stroke rate, count */ + 1 /* avg stroke rate */ \
+                              + 3 /* distance */ + 2 + 2 /* inst, avg pace */ + 2 + 2 /* inst, avg power */ \
+                              + 2 /* elapsed time */)
+#define ROWER_DATA_ENERGY_SIZE (2 + 2 + 1) /* total, per hour, per minute */
+#define ROWER_DATA_FULL_SIZE (ROWER_DATA_BASE_SIZE + ROWER_DATA_ENERGY_SIZE)
 
 static ssize_t read_feature(struct bt_conn *conn, const struct bt_gatt_attr *attr,
 			    void *buf, uint16_t len, uint16_t offset)
@@ -52,7 +61,7 @@ void FTMS::init() {
     LOG_INF("FTMS Service Initialized");
 }
 
-void FTMS::notifyRowingData(struct bt_conn *conn, const RowingData& data) {
+void FTMS::notifyRowingData(struct bt_conn *conn, const RowingData<>& data) {
     if (conn == nullptr) {
         // Safety net to make sure not nullptr goes through
         return;
@@ -68,8 +77,12 @@ void FTMS::notifyRowingData(struct bt_conn *conn, const RowingData& data) {
        Bit 4: 1 (Avg Pace Present)
        Bit 5: 1 (Inst Power Present)
        Bit 6: 1 (Avg Power Present)
+       Bit 8: 1 (Expended Energy Present), if the MTU has room for it
        Bit 11: 1 (Elapsed Time Present)
     */
+    // A client that never raised the MTU from 23 gets the packet without energy
+    bool sendEnergy = (bt_gatt_get_mtu(conn) - 3) >= ROWER_DATA_FULL_SIZE;
+
     uint16_t flags = 0;
     flags |= BIT(1);
     flags |= BIT(2);
@@ -77,29 +90,38 @@ void FTMS::notifyRowingData(struct bt_conn *conn, const RowingData& data) {
     flags |= BIT(4);
     flags |= BIT(5);
     flags |= BIT(6);
+    if (sendEnergy) {
+        flags |= BIT(8);
+    }
     flags |= BIT(11);
 
-    uint8_t buffer[30];
+    uint8_t buffer[ROWER_DATA_FULL_SIZE];
     uint8_t cursor = 0;
 
-    auto clampU8  = [](double v) -> uint8_t  { return (v != v || v < 0) ? 0 : (v > 255 ? 255 : (uint8_t)v); };
-    auto clampU16 = [](double v) -> uint16_t { return (v != v || v < 0) ? 0 : (v > 65535 ? 65535 : (uint16_t)v); };
-    auto clampU24 = [](double v) -> uint32_t { return (v != v || v < 0) ? 0 : (v > 16777215 ? 16777215 : (uint32_t)v); };
-    auto clampS16 = [](double v) -> int16_t  { return (v != v) ? 0 : (v < -32768 ? -32768 : (v > 32767 ? 32767 : (int16_t)v)); };
+    // Metrics arrive as PhysicsScalar (double or Q-format), so convert to integer once
+    // and clamp in integer arithmetic. NaN only exists for the double engine.
+    auto toInt    = [](PhysicsScalar v) -> int64_t  {
+        const PhysicsScalar limit(1000000000);
+        return (v != v) ? 0 : (v > limit ? 1000000000 : (v < -limit ? -1000000000 : static_cast<int64_t>(v)));
+    };
+    auto clampU8  = [&](PhysicsScalar s) -> uint8_t  { int64_t v = toInt(s); return (v < 0) ? 0 : (v > 255 ? 255 : (uint8_t)v); };
+    auto clampU16 = [&](PhysicsScalar s) -> uint16_t { int64_t v = toInt(s); return (v < 0) ? 0 : (v > 65535 ? 65535 : (uint16_t)v); };
+    auto clampU24 = [&](PhysicsScalar s) -> uint32_t { int64_t v = toInt(s); return (v < 0) ? 0 : (v > 16777215 ? 16777215 : (uint32_t)v); };
+    auto clampS16 = [&](PhysicsScalar s) -> int16_t  { int64_t v = toInt(s); return (v < -32768) ? -32768 : (v > 32767 ? 32767 : (int16_t)v); };
 
     // [1] Flags (UINT16)
-    sys_put_le16(clampU16(flags), &buffer[cursor]);
+    sys_put_le16(flags, &buffer[cursor]);
     cursor += 2;
 
     // [2] Inst. Stroke Rate (UINT8 - 0.5 unit) & Stroke Count (UINT16)
     // Present because Bit 0 is 0
-    buffer[cursor++] = clampU8(data.spm * 2.0);
-    sys_put_le16(clampU16(data.strokeCount), &buffer[cursor]);
+    buffer[cursor++] = clampU8(data.spm * PhysicsScalar(2));
+    sys_put_le16((data.strokeCount < 0) ? 0 : (data.strokeCount > 65535 ? 65535 : (uint16_t)data.strokeCount), &buffer[cursor]);
     cursor += 2;
 
     // [3] Average Stroke Rate (UINT8 - 0.5 unit)
     // Present because Bit 1 is 1
-    buffer[cursor++] = clampU8(data.avgSpm * 2.0);
+    buffer[cursor++] = clampU8(data.avgSpm * PhysicsScalar(2));
 
     // [4] Total Distance (UINT24 - Meters)
     // Present because Bit 2 is 1
@@ -108,13 +130,13 @@ void FTMS::notifyRowingData(struct bt_conn *conn, const RowingData& data) {
 
     // [5] Instantaneous Pace (UINT16 - Seconds per 500m)
     // Present because Bit 3 is 1
-    double rawPace = (data.instSpeed > 0.1) ? (500.0 / data.instSpeed) : 0;
+    PhysicsScalar rawPace = (data.instSpeed > PhysicsScalar(0.1)) ? (PhysicsScalar(500) / data.instSpeed) : PhysicsScalar(0);
     sys_put_le16(clampU16(rawPace), &buffer[cursor]);
     cursor += 2;
 
     // [6] Average Pace (UINT16 - Seconds per 500m)
     // Present because Bit 4 is 1
-    double avgPace = (data.avgSpeed > 0.1) ? (500.0 / data.avgSpeed) : 0;
+    PhysicsScalar avgPace = (data.avgSpeed > PhysicsScalar(0.1)) ? (PhysicsScalar(500) / data.avgSpeed) : PhysicsScalar(0);
     sys_put_le16(clampU16(avgPace), &buffer[cursor]);
     cursor += 2;
 
@@ -128,13 +150,25 @@ void FTMS::notifyRowingData(struct bt_conn *conn, const RowingData& data) {
     sys_put_le16(clampS16(data.avgPower), &buffer[cursor]);
     cursor += 2;
 
-    // [9] Elapsed Time (UINT16 - Seconds)
+    // [9] Total Energy (UINT16 - kcal), Energy per Hour (UINT16 - kcal),
+    //     Energy per Minute (UINT8 - kcal)
+    // Present because Bit 8 is 1
+    if (sendEnergy) {
+        sys_put_le16(clampU16(data.totalEnergy), &buffer[cursor]);
+        cursor += 2;
+        sys_put_le16(clampU16(data.energyPerHour), &buffer[cursor]);
+        cursor += 2;
+        buffer[cursor++] = clampU8(data.energyPerHour / PhysicsScalar(60));
+    }
+
+    // [10] Elapsed Time (UINT16 - Seconds)
     // Present because Bit 11 is 1
-    double elapsedTime =  !data.sessionActive ? 0 : ((double)(k_uptime_get_32() - data.sessionStartTime)/1000.00);
-    sys_put_le16(clampU16(elapsedTime), &buffer[cursor]);
+    uint32_t elapsedTime = !data.sessionActive ? 0 : ((k_uptime_get_32() - data.sessionStartTime) / 1000);
+    sys_put_le16((elapsedTime > 65535) ? 65535 : (uint16_t)elapsedTime, &buffer[cursor]);
     cursor += 2;
 
-    // Total buffer size used will be 18 bytes
+    // Total buffer size used will be 19 bytes, 24 with energy
+    __ASSERT_NO_MSG(cursor == (sendEnergy ? ROWER_DATA_FULL_SIZE : ROWER_DATA_BASE_SIZE));
     int err = bt_gatt_notify(conn, &ftms_svc.attrs[2], buffer, cursor);
     if (err) {
         // LOG_WRN("Notify failed (err %d)", err);
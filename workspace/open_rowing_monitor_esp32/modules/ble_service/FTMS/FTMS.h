@@ -37,7 +37,7 @@ public:
      * @brief Sends a notification with the latest rowing data
      * @param data The struct from your RowingEngine
      */
-    void notifyRowingData(struct bt_conn *conn, const RowingData& data);
+    void notifyRowingData(struct bt_conn *conn, const RowingData<>& data);
 };
 
 #endif // FTMS_H
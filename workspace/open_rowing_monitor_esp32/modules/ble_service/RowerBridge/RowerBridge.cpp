@@ -5,14 +5,14 @@ LOG_MODULE_REGISTER(RowerBridge, LOG_LEVEL_INF);
 
 struct Context {
     FTMS* tmp_service;
-    RowingData* tmp_data;
+    RowingData<>* tmp_data;
 };
 
-RowerBridge::RowerBridge(RowingEngine& engine, FTMS& service, BleManager& blemanager)
-    : m_engine(engine), m_service(service), m_blemanager(blemanager) {
+RowerBridge::RowerBridge(RowingEngine<>& engine, FTMS& service, BleManager& blemanager, int rower)
+    : m_engine(engine), m_service(service), m_blemanager(blemanager), m_rower(rower) {
     }
 void RowerBridge::init() {
-    LOG_INF("RowerBridge Initialized");
+    LOG_INF("RowerBridge Initialized (rower %d)", m_rower);
 }
 void RowerBridge::update() {
     // 1. Check if enough time has passed (Rate Limiting)
@@ -23,13 +23,13 @@ void RowerBridge::update() {
     last_update_time = now;
 
     // 2. Get Fresh Data from Physics Engine
-    RowingData data = m_engine.getData();
+    RowingData<> data = m_engine.getData();
     // m_engine.printData();
     // m_engine.logDragFactor();
 
     Context ctx = {&m_service, &data};
-    // 3. Send data to all clients
-    m_blemanager.forEachConnection([](struct bt_conn *conn, void *ptr) {
+    // 3. Send data to all clients of this rower
+    m_blemanager.forEachConnection(m_rower, [](struct bt_conn *conn, void *ptr) {
         Context *c = static_cast<Context*>(ptr);
         c->tmp_service->notifyRowingData(conn, *(c->tmp_data));
     }, &ctx);
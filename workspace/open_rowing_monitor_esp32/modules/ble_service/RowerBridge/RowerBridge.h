@@ -7,7 +7,8 @@
 
 class RowerBridge {
 public:
-    RowerBridge(RowingEngine& engine, FTMS& service, BleManager& blemanager);
+    // Sends the engine's data to the apps connected to this rower
+    RowerBridge(RowingEngine<>& engine, FTMS& service, BleManager& blemanager, int rower = 0);
     void init();
     /**
      * @brief Call this in your main loop to handle data updates
@@ -15,9 +16,10 @@ public:
     void update();
     // static void sendToClient(struct bt_conn *conn, void *ptr);
 private:
-    RowingEngine& m_engine;
+    RowingEngine<>& m_engine;
     FTMS& m_service;
     BleManager& m_blemanager;
+    int m_rower;
 
     // Rate limiting: We don't want to spam BLE (max 2-4 Hz is good)
     uint32_t last_update_time = 0;
@@ -0,0 +1,98 @@
+#include "SettingsService.h"
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/bluetooth/conn.h>
+
+#include "SettingsTable.h"
+
+LOG_MODULE_REGISTER(SettingsService, LOG_LEVEL_INF);
+
+#define SETTINGS_WRITE_SIZE 5
+#define SETTINGS_READ_SIZE (5 + 4 * (int)SettingId::COUNT)
+
+// GATT callbacks are plain functions, they reach the store through here
+static RowingSettingsStore *settingsStore = nullptr;
+
+static ssize_t read_settings(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			     void *buf, uint16_t len, uint16_t offset)
+{
+	uint8_t data[SETTINGS_READ_SIZE];
+	if (settingsStore == nullptr) {
+		return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+	}
+
+	// Version first: values newer than it only make the next read differ
+	sys_put_le32(settingsStore->getVersion(), &data[0]);
+	RowingSettings<> settings = settingsStore->read();
+	data[4] = (uint8_t)SettingId::COUNT;
+	for (int i = 0; i < (int)SettingId::COUNT; i++) {
+		sys_put_le32((uint32_t)getSetting(settings, (SettingId)i), &data[5 + 4 * i]);
+	}
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, data, sizeof(data));
+}
+
+static ssize_t write_settings(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			      const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+	if (settingsStore == nullptr) {
+		return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+	}
+	if (offset != 0) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+	}
+	if (len != SETTINGS_WRITE_SIZE) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	}
+
+	const uint8_t *data = (const uint8_t *)buf;
+	SettingId id = (SettingId)data[0];
+	int32_t value = (int32_t)sys_get_le32(&data[1]);
+	if (id >= SettingId::COUNT) {
+		return BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE);
+	}
+
+	uint32_t version = settingsStore->update([&](RowingSettings<> &settings) {
+		return setSetting(settings, id, value);
+	});
+	if (version == 0) {
+		LOG_WRN("Rejected %s = %d", settingInfo[(int)id].name, value);
+		return BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE);
+	}
+	LOG_INF("%s = %d, settings version %u", settingInfo[(int)id].name, value, version);
+	return len;
+}
+
+BT_GATT_SERVICE_DEFINE(settings_svc,
+    BT_GATT_PRIMARY_SERVICE(BT_UUID_ORM_SETTINGS),
+
+    // Characteristic: every setting on read, one setting per write
+    BT_GATT_CHARACTERISTIC(BT_UUID_ORM_SETTINGS_VALUES,
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                           BT_GATT_PERM_READ | BT_GATT_PERM_WRITE_AUTHEN,
+                           read_settings, write_settings, NULL)
+);
+
+// No keypad or screen: the passkey goes to the console, which makes the
+// pairing authenticated (display only) instead of Just Works
+static void passkeyDisplay(struct bt_conn *conn, unsigned int passkey) {
+    ARG_UNUSED(conn);
+    LOG_INF("Pairing passkey for the settings: %06u", passkey);
+}
+
+static void pairingCancel(struct bt_conn *conn) {
+    ARG_UNUSED(conn);
+    LOG_INF("Pairing cancelled");
+}
+
+static struct bt_conn_auth_cb authCallbacks = {
+    .passkey_display = passkeyDisplay,
+    .cancel = pairingCancel,
+};
+
+void SettingsService::init(RowingSettingsStore &store) {
+    settingsStore = &store;
+    int err = bt_conn_auth_cb_register(&authCallbacks);
+    if (err != 0) {
+        LOG_ERR("Pairing callbacks not registered (%d), settings writes will be refused", err);
+    }
+    LOG_INF("Settings Service Initialized (%d settings)", (int)SettingId::COUNT);
+}
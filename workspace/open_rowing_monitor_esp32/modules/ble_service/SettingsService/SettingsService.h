@@ -0,0 +1,33 @@
+#ifndef SETTINGS_SERVICE_H
+#define SETTINGS_SERVICE_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/logging/log.h>
+
+#include "SettingsStore.h"
+
+// Vendor service with one Read | Write characteristic (CONFIG_ORM_SETTINGS_BLE)
+#define BT_UUID_ORM_SETTINGS_VAL \
+    BT_UUID_128_ENCODE(0x4f524d00, 0x5345, 0x5454, 0x494e, 0x475300000000)
+#define BT_UUID_ORM_SETTINGS          BT_UUID_DECLARE_128(BT_UUID_ORM_SETTINGS_VAL)
+#define BT_UUID_ORM_SETTINGS_VALUES_VAL \
+    BT_UUID_128_ENCODE(0x4f524d01, 0x5345, 0x5454, 0x494e, 0x475300000000)
+#define BT_UUID_ORM_SETTINGS_VALUES   BT_UUID_DECLARE_128(BT_UUID_ORM_SETTINGS_VALUES_VAL)
+
+class SettingsService {
+public:
+    /**
+     * @brief Serve the runtime settings of store, call this once at startup
+     *
+     * Read:  [version u32][count u8][value int32 x count], little endian,
+     *        values in SettingId order and Kconfig units (SettingsTable.h)
+     * Write: [id u8][value int32], publishes a new version with that setting.
+     *        A value the table rejects answers Out Of Range. Only over an
+     *        authenticated link: the passkey is shown on the console.
+     */
+    void init(RowingSettingsStore &store);
+};
+
+#endif // SETTINGS_SERVICE_H
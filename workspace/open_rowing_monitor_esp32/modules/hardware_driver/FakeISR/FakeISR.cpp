@@ -17,7 +17,7 @@ K_THREAD_STACK_DEFINE(fake_isr_stack, 2048);
 
 static FakeISR* instance = nullptr;
 
-FakeISR::FakeISR(RowingEngine& engine, bool loop)
+FakeISR::FakeISR(RowingEngine<>& engine, bool loop)
     : m_engine(engine),
       m_loop(loop),
       m_is_running(false),
@@ -25,7 +25,7 @@ FakeISR::FakeISR(RowingEngine& engine, bool loop)
 
           instance = this;
 
-          k_msgq_init(&m_queue, m_queue_buffer, sizeof(uint32_t), IMPULSE_QUEUE_SIZE);
+          k_msgq_init(&m_queue, m_queue_buffer, sizeof(ImpulseSample), IMPULSE_QUEUE_SIZE);
 
           k_thread_create(&physicsThreadData,
                           physicsThreadStack,
@@ -45,6 +45,9 @@ void FakeISR::start() {
     LOG_INF("Starting Fake ISR (replaying %zu impulses)", m_data_count);
     m_is_running = true;
     m_current_index = 0;
+    m_decimator.reset();
+    m_losses.reset();
+    m_losses.setGate(m_engine.getMinimumImpulseCycles(), m_engine.getMaximumImpulseCycles());
 
     k_thread_create(&thread_data,
                     fake_isr_stack,
@@ -72,13 +75,19 @@ void FakeISR::physicsThreadEntryPoint(void* p1, void* p2, void* p3) {
 }
 
 void FakeISR::physicsLoop() {
-    uint32_t deltaCycles;
+    ImpulseSample sample;
+    bool moving = false;
     LOG_INF("Physics loop thread started");
 
     while (true) {
-        if (k_msgq_get(&m_queue, &deltaCycles, K_FOREVER) == 0) {
-            double dt = (double)deltaCycles / (double)sys_clock_hw_cycles_per_sec();
-            m_engine.handleRotationImpulse(dt);
+        // Same pause detection as the real services: stop() pauses the engine
+        k_timeout_t timeout = moving ? K_MSEC(m_engine.impulseTimeoutMs()) : K_FOREVER;
+        if (k_msgq_get(&m_queue, &sample, timeout) == 0) {
+            m_engine.handleRotationImpulse(sample.deltaCycles, sample.missed);
+            moving = true;
+        } else if (moving) {
+            m_engine.handleImpulseTimeout();
+            moving = false;
         }
     }
 }
@@ -100,12 +109,17 @@ void FakeISR::replayLoop() {
         // Convert to cycles (same as real ISR)
         uint32_t deltaCycles = (uint32_t)(dt * sys_clock_hw_cycles_per_sec());
 
-        // Send to physics thread via message queue
-        int ret = k_msgq_put(&m_queue, &deltaCycles, K_NO_WAIT);
+        // Send each full bin to the physics thread via message queue
+        uint32_t binCycles;
+        if (m_decimator.push(deltaCycles, binCycles)) {
+            bool queued = m_losses.offer(binCycles, [this](const ImpulseSample &sample) {
+                return k_msgq_put(&m_queue, &sample, K_NO_WAIT) == 0;
+            });
 
-        if (ret != 0) {
-            LOG_ERR("Queue full! Physics thread can't keep up");
-            // In real ISR this would be a serious problem
+            if (!queued) {
+                LOG_ERR("Queue full! Physics thread can't keep up (%u impulses lost)", m_losses.getTotalLost());
+                // Its time rides along with the next impulse that gets through
+            }
         }
 
         // Wait the actual dt time to simulate real timing
@@ -3,9 +3,11 @@
 #include <zephyr/kernel.h>
 #include "RowingEngine.h"
 #include "TestData.h"
+#include "ImpulseDecimator.h"
+#include "ImpulseSample.h"
 
 
-#define IMPULSE_QUEUE_SIZE (CONFIG_FAKEISR_IMPULSE_QUEUE_SIZE * CONFIG_ORM_IMPULSES_PER_REV)
+#define IMPULSE_QUEUE_SIZE (CONFIG_FAKEISR_IMPULSE_QUEUE_SIZE * ORM_ENGINE_IMPULSES_PER_REV)
 
 /**
  * @brief Fake ISR for Testing
@@ -20,14 +22,14 @@ public:
      * @param impulseQueue - The same queue used by GpioTimerService
      * @param loop - If true, continuously loop through data
      */
-    FakeISR(RowingEngine& engine, bool loop = true);
+    FakeISR(RowingEngine<>& engine, bool loop = true);
     void start();
     void stop();
     size_t getDtCount();
     bool isRunning() const { return m_is_running; }
 
 private:
-    RowingEngine& m_engine;
+    RowingEngine<>& m_engine;
     const double* m_test_data = dtValues;
     size_t m_data_count = dtCount;
     bool m_loop;
@@ -35,7 +37,9 @@ private:
     size_t m_current_index;
 
     struct k_msgq m_queue;
-    char __aligned(8) m_queue_buffer[IMPULSE_QUEUE_SIZE * sizeof(uint32_t)];
+    char __aligned(8) m_queue_buffer[IMPULSE_QUEUE_SIZE * sizeof(ImpulseSample)];
+    ImpulseDecimator<> m_decimator;     // Bins like the real services
+    ImpulseLossCounter m_losses;
 
     struct k_thread thread_data;
     struct k_thread physicsThreadData;
@@ -11,20 +11,47 @@ K_THREAD_STACK_DEFINE(physicsThreadStack, CONFIG_GPIO_PHYSICS_THREAD_STACK_SIZE)
 
 #define PHYSICS_PRIORITY 5
 
-// 1. GLOBAL STATIC POINTER (Singleton-ish access for ISR)
-static GpioTimerService* instance = nullptr;
-
-GpioTimerService::GpioTimerService(RowingEngine &eng, const RowingSettings &rs)
-    :   settings(rs),
-        engine(eng),
-        sensorSpec(GPIO_DT_SPEC_GET(DT_ALIAS(impulse_sensor), gpios)),
-        lastCycleTime(0),
-        isFirstPulse(true) {
+// Impulse sensor of every rower, from the devicetree aliases
+#if CONFIG_ORM_ROWER_COUNT > 1
+BUILD_ASSERT(DT_HAS_ALIAS(impulse_sensor_1), "CONFIG_ORM_ROWER_COUNT > 1 needs the alias 'impulse-sensor-1'");
+#endif
+#if CONFIG_ORM_ROWER_COUNT > 2
+BUILD_ASSERT(DT_HAS_ALIAS(impulse_sensor_2), "CONFIG_ORM_ROWER_COUNT > 2 needs the alias 'impulse-sensor-2'");
+#endif
+#if CONFIG_ORM_ROWER_COUNT > 3
+BUILD_ASSERT(DT_HAS_ALIAS(impulse_sensor_3), "CONFIG_ORM_ROWER_COUNT > 3 needs the alias 'impulse-sensor-3'");
+#endif
 
-    // Set the global instance to 'this'
-    instance = this;
-    minCycles = (uint32_t)(settings.minimumTimeBetweenImpulses * (double)sys_clock_hw_cycles_per_sec());
-    k_msgq_init(&impulseQueue, impulseQueueBuffer, sizeof(uint32_t), IMPULSE_QUEUE_SIZE);
+static const struct gpio_dt_spec sensorSpecs[CONFIG_ORM_ROWER_COUNT] = {
+    GPIO_DT_SPEC_GET(DT_ALIAS(impulse_sensor), gpios),
+#if CONFIG_ORM_ROWER_COUNT > 1
+    GPIO_DT_SPEC_GET(DT_ALIAS(impulse_sensor_1), gpios),
+#endif
+#if CONFIG_ORM_ROWER_COUNT > 2
+    GPIO_DT_SPEC_GET(DT_ALIAS(impulse_sensor_2), gpios),
+#endif
+#if CONFIG_ORM_ROWER_COUNT > 3
+    GPIO_DT_SPEC_GET(DT_ALIAS(impulse_sensor_3), gpios),
+#endif
+};
+
+GpioTimerService::GpioTimerService(RowingEngine<> (&engines)[CONFIG_ORM_ROWER_COUNT], const DefaultRowingSettings<> &rs)
+    :   settings(rs) {
+
+    minCycles = (uint32_t)(static_cast<double>(settings.minimumTimeBetweenImpulses) * (double)sys_clock_hw_cycles_per_sec());
+    k_sem_init(&impulseSignal, 0, K_SEM_MAX_LIMIT);
+
+    for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+        Sensor &sensor = sensors[i];
+        sensor.service = this;
+        sensor.engine = &engines[i];
+        sensor.spec = sensorSpecs[i];
+        sensor.lastCycleTime = 0;
+        sensor.isFirstPulse = true;
+        sensor.lastImpulseMs = 0;
+        sensor.moving = false;
+        k_msgq_init(&sensor.impulseQueue, sensor.impulseQueueBuffer, sizeof(ImpulseSample), IMPULSE_QUEUE_SIZE);
+    }
 
     k_thread_create(&physicsThreadData,
                     physicsThreadStack,
@@ -37,21 +64,24 @@ GpioTimerService::GpioTimerService(RowingEngine &eng, const RowingSettings &rs)
 }
 
 int GpioTimerService::init() {
-    if (!gpio_is_ready_dt(&sensorSpec)) {
-        LOG_ERR("GPIO device not ready");
-        return -1;
-    }
+    for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+        Sensor &sensor = sensors[i];
+        if (!gpio_is_ready_dt(&sensor.spec)) {
+            LOG_ERR("GPIO device of rower %d not ready", i);
+            return -1;
+        }
 
-    int ret = gpio_pin_configure_dt(&sensorSpec, GPIO_INPUT);
-    if (ret < 0) return ret;
+        int ret = gpio_pin_configure_dt(&sensor.spec, GPIO_INPUT);
+        if (ret < 0) return ret;
 
-    ret = gpio_pin_interrupt_configure_dt(&sensorSpec, GPIO_INT_DISABLE);
-    if (ret < 0) return ret;
+        ret = gpio_pin_interrupt_configure_dt(&sensor.spec, GPIO_INT_DISABLE);
+        if (ret < 0) return ret;
 
-    gpio_init_callback(&pinCbData, interruptHandlerStatic, BIT(sensorSpec.pin));
-    gpio_add_callback(sensorSpec.port, &pinCbData);
+        gpio_init_callback(&sensor.pinCbData, interruptHandlerStatic, BIT(sensor.spec.pin));
+        gpio_add_callback(sensor.spec.port, &sensor.pinCbData);
 
-    LOG_INF("GpioTimerService initialized on pin %d", sensorSpec.pin);
+        LOG_INF("GpioTimerService: rower %d on pin %d", i, sensor.spec.pin);
+    }
     return 0;
 }
 
@@ -61,8 +91,9 @@ void GpioTimerService::physicsThreadEntryPoint(void* p1, void* p2, void* p3) {
 }
 
 void GpioTimerService::physicsLoop() {
-    uint32_t deltaCycles;
-    LOG_INF("Physics loop thread started");
+    ImpulseSample sample;
+    int lastRower = CONFIG_ORM_ROWER_COUNT - 1;
+    LOG_INF("Physics loop thread started (%d rowers)", CONFIG_ORM_ROWER_COUNT);
 
     // Monitoring Variables
     #ifdef CONFIG_GPIO_ENABLE_PHYSICS_PROFILING
@@ -72,104 +103,191 @@ void GpioTimerService::physicsLoop() {
 
     uint32_t maxProcessingTime = 0;
     uint32_t totalProcessingTime = 0;
+    uint64_t totalProcessingCycles = 0;
+
+    // Per rower: impulses and the deepest its queue got
+    uint32_t rowerImpulses[CONFIG_ORM_ROWER_COUNT] = {};
+    uint32_t maxQueued[CONFIG_ORM_ROWER_COUNT] = {};
     #endif
 
     while (true) {
-        if (k_msgq_get(&impulseQueue, &deltaCycles, K_FOREVER) == 0) {
-
+        // Wakes for the next impulse, or when a rower should have had one
+        int ret = k_sem_take(&impulseSignal, nextPauseTimeout(k_uptime_get()));
+        pauseStoppedRowers(k_uptime_get());
+        if (ret != 0) continue;
+
+        // Every count was given after a put, so one of the queues has it.
+        // Start after the rower served last, so no sensor waits behind another.
+        Sensor *sensor = nullptr;
+        for (int n = 0; n < CONFIG_ORM_ROWER_COUNT; n++) {
+            lastRower = (lastRower + 1 == CONFIG_ORM_ROWER_COUNT) ? 0 : lastRower + 1;
             #ifdef CONFIG_GPIO_ENABLE_PHYSICS_PROFILING
-            uint32_t startCycles = k_cycle_get_32();
+            uint32_t queued = k_msgq_num_used_get(&sensors[lastRower].impulseQueue);
+            if (queued > maxQueued[lastRower]) maxQueued[lastRower] = queued;
             #endif
+            if (k_msgq_get(&sensors[lastRower].impulseQueue, &sample, K_NO_WAIT) == 0) {
+                sensor = &sensors[lastRower];
+                break;
+            }
+        }
+        if (sensor == nullptr) continue;
+        sensor->lastImpulseMs = k_uptime_get();
+        sensor->moving = true;
+
+        #ifdef CONFIG_GPIO_ENABLE_PHYSICS_PROFILING
+        uint32_t startCycles = k_cycle_get_32();
+        #endif
+
+        // === THE ACTUAL WORK ===
+        sensor->engine->handleRotationImpulse(sample.deltaCycles, sample.missed);
+
+        #ifdef CONFIG_GPIO_ENABLE_PHYSICS_PROFILING
+        impulseCount++;
+        rowerImpulses[lastRower]++;
+        uint32_t elapsed = k_cycle_get_32() - startCycles;
+        uint32_t elapsedUs = k_cyc_to_us_floor32(elapsed);
+        totalProcessingTime += elapsedUs;
+        totalProcessingCycles += elapsed;
+        if (elapsedUs > maxProcessingTime) {
+            maxProcessingTime = elapsedUs;
+            LOG_DBG("New max processing time: %u us", maxProcessingTime);
+        }
 
-            // === THE ACTUAL WORK ===
-            double dt = (double)deltaCycles / (double)sys_clock_hw_cycles_per_sec();
-            engine.handleRotationImpulse(dt);
+        // ===============================================
+        // INLINE STACK MONITORING (Every 50 impulses)
+        // ===============================================
+        if (impulseCount % 50 == 0) {
+            size_t unused;
+            if (k_thread_stack_space_get(&physicsThreadData, &unused) == 0) {
+                if (unused < minStackFree) {
+                    minStackFree = unused;
+                    LOG_WRN("Physics thread LOW WATER MARK: %u bytes free (impulse #%u)",
+                            unused, impulseCount);
+                }
 
-            #ifdef CONFIG_GPIO_ENABLE_PHYSICS_PROFILING
-            impulseCount++;
-            uint32_t elapsed = k_cycle_get_32() - startCycles;
-            uint32_t elapsedUs = k_cyc_to_us_floor32(elapsed);
-            totalProcessingTime += elapsedUs;
-            if (elapsedUs > maxProcessingTime) {
-                maxProcessingTime = elapsedUs;
-                LOG_DBG("New max processing time: %u us", maxProcessingTime);
+                // Critical warning if below 512 bytes
+                if (unused < 512) {
+                    LOG_ERR("CRITICAL: Physics stack almost full! %u bytes remaining!", unused);
+                }
             }
+        }
 
-            // ===============================================
-            // INLINE STACK MONITORING (Every 50 impulses)
-            // ===============================================
-            if (impulseCount % 50 == 0) {
-                size_t unused;
-                if (k_thread_stack_space_get(&physicsThreadData, &unused) == 0) {
-                    if (unused < minStackFree) {
-                        minStackFree = unused;
-                        LOG_WRN("Physics thread LOW WATER MARK: %u bytes free (impulse #%u)",
-                                unused, impulseCount);
-                    }
-
-                    // Critical warning if below 512 bytes
-                    if (unused < 512) {
-                        LOG_ERR("CRITICAL: Physics stack almost full! %u bytes remaining!", unused);
-                    }
-                }
+        // ===============================================
+        // PERIODIC DETAILED REPORT (Every 30 seconds)
+        // ===============================================
+        uint32_t now = k_uptime_get_32();
+        if ((now - lastMonitorTime) > 30000) {
+            LOG_INF("=== Physics Thread Report ===");
+            LOG_INF("  Uptime: %u seconds", now / 1000);
+            LOG_INF("  Total Impulses: %u", impulseCount);
+            LOG_INF("  Stack Low Water Mark: %u bytes", minStackFree);
+
+            if (impulseCount > 0) {
+                uint32_t avgTime = totalProcessingTime / impulseCount;
+                LOG_INF("  Avg processing time: %u us", avgTime);
+                LOG_INF("  Max processing time: %u us", maxProcessingTime);
+                LOG_INF("  Avg timer cycles/impulse (%s): %u", PHYSICS_SCALAR_NAME,
+                        (uint32_t)(totalProcessingCycles / impulseCount));
             }
 
-            // ===============================================
-            // PERIODIC DETAILED REPORT (Every 30 seconds)
-            // ===============================================
-            uint32_t now = k_uptime_get_32();
-            if ((now - lastMonitorTime) > 30000) {
-                LOG_INF("=== Physics Thread Report ===");
-                LOG_INF("  Uptime: %u seconds", now / 1000);
-                LOG_INF("  Total Impulses: %u", impulseCount);
-                LOG_INF("  Stack Low Water Mark: %u bytes", minStackFree);
-
-                if (impulseCount > 0) {
-                    uint32_t avgTime = totalProcessingTime / impulseCount;
-                    LOG_INF("  Avg processing time: %u us", avgTime);
-                    LOG_INF("  Max processing time: %u us", maxProcessingTime);
+            for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+                RowingEngine<> &engine = *sensors[i].engine;
+                LOG_INF("  Rower %d: %u impulses, queue peak %u/%u", i, rowerImpulses[i],
+                        maxQueued[i], IMPULSE_QUEUE_SIZE);
+                LOG_INF("  Impulses lost to a full queue: %u, rebuilt %u", sensors[i].losses.getTotalLost(),
+                        engine.getMissedImpulses());
+                LOG_INF("  Data reader retries: %u", engine.getReaderRetries());
+
+                StrokeStageStats strokeStats = engine.getStrokeStageStats();
+                LOG_INF("  Stroke records: %u processed, %u dropped", strokeStats.processed, strokeStats.dropped);
+                if (strokeStats.processed > 0) {
+                    LOG_INF("  Stroke stage cycles: avg %u, max %u",
+                            (uint32_t)(strokeStats.totalCycles / strokeStats.processed), strokeStats.maxCycles);
                 }
-
-                LOG_INF("=============================");
-                lastMonitorTime = now;
             }
-            #endif
+
+            LOG_INF("=============================");
+            lastMonitorTime = now;
         }
+        #endif
     }
 }
 
-void GpioTimerService::interruptHandlerStatic(const struct device *dev, struct gpio_callback *cb, uint32_t pins) {
-    if (instance) {
-        instance->handleInterrupt();
+k_timeout_t GpioTimerService::nextPauseTimeout(int64_t now) {
+    int64_t deadline = INT64_MAX;
+    for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+        const Sensor &sensor = sensors[i];
+        if (sensor.moving) {
+            int64_t rowerDeadline = sensor.lastImpulseMs + sensor.engine->impulseTimeoutMs();
+            if (rowerDeadline < deadline) deadline = rowerDeadline;
+        }
     }
+    if (deadline == INT64_MAX) return K_FOREVER;
+    return (deadline > now) ? K_MSEC(deadline - now) : K_NO_WAIT;
 }
 
-void GpioTimerService::handleInterrupt() {
+void GpioTimerService::pauseStoppedRowers(int64_t now) {
+    for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+        Sensor &sensor = sensors[i];
+        if (sensor.moving && now - sensor.lastImpulseMs >= sensor.engine->impulseTimeoutMs()) {
+            sensor.engine->handleImpulseTimeout();
+            sensor.moving = false;
+        }
+    }
+}
+
+void GpioTimerService::interruptHandlerStatic(const struct device *dev, struct gpio_callback *cb, uint32_t pins) {
+    Sensor *sensor = CONTAINER_OF(cb, Sensor, pinCbData);
+    sensor->service->handleInterrupt(*sensor);
+}
+
+void GpioTimerService::handleInterrupt(Sensor &sensor) {
     uint32_t currentCycles = k_cycle_get_32();
 
-    if (isFirstPulse) {
-        lastCycleTime = currentCycles;
-        isFirstPulse = false;
+    if (sensor.isFirstPulse) {
+        sensor.lastCycleTime = currentCycles;
+        sensor.isFirstPulse = false;
         return;
     }
 
-    uint32_t deltaCycles = currentCycles - lastCycleTime;
+    uint32_t deltaCycles = currentCycles - sensor.lastCycleTime;
     // if(deltaCycles < minCycles) return;
-    lastCycleTime = currentCycles;
+    sensor.lastCycleTime = currentCycles;
+
+    // High-resolution discs: one entry per bin of impulses
+    if (!sensor.decimator.push(deltaCycles, deltaCycles)) return;
 
+    // A full queue loses the impulse but not its time, the next one carries both
+    bool queued = sensor.losses.offer(deltaCycles, [&sensor](const ImpulseSample &sample) {
+        return k_msgq_put(&sensor.impulseQueue, &sample, K_NO_WAIT) == 0;
+    });
+    if (queued) {
+        k_sem_give(&impulseSignal);
+    }
+}
+
+void GpioTimerService::pause(int rower) {
+    gpio_pin_interrupt_configure_dt(&sensors[rower].spec, GPIO_INT_DISABLE);
+    LOG_INF("Rower %d PAUSED (Interrupts disabled)", rower);
+}
 
-    k_msgq_put(&impulseQueue, &deltaCycles, K_NO_WAIT);
+void GpioTimerService::resume(int rower) {
+    sensors[rower].isFirstPulse = true; // Reset state so the first stroke isn't huge
+    sensors[rower].decimator.reset();
+    sensors[rower].losses.reset();
+    // A lost bounce is dropped the way the engine drops it, time included
+    sensors[rower].losses.setGate(sensors[rower].engine->getMinimumImpulseCycles(),
+                                  sensors[rower].engine->getMaximumImpulseCycles());
+    gpio_pin_interrupt_configure_dt(&sensors[rower].spec, GPIO_INT_EDGE_TO_ACTIVE);
+    LOG_INF("Rower %d RESUMED", rower);
 }
 
 void GpioTimerService::pause() {
-    gpio_pin_interrupt_configure_dt(&sensorSpec, GPIO_INT_DISABLE);
-    LOG_INF("Physics Engine PAUSED (Interrupts disabled)");
+    for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) pause(i);
 }
 
 void GpioTimerService::resume() {
-    isFirstPulse = true; // Reset state so the first stroke isn't huge
-    gpio_pin_interrupt_configure_dt(&sensorSpec, GPIO_INT_EDGE_TO_ACTIVE);
-    LOG_INF("Physics Engine RESUMED");
+    for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) resume(i);
 }
 
 struct k_thread* GpioTimerService::getPhysicsThread() {
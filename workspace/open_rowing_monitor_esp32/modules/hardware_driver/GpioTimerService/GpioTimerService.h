@@ -4,34 +4,64 @@
 #include <zephyr/drivers/gpio.h>
 #include "RowingSettings.h"
 #include "RowingEngine.h"
+#include "ImpulseDecimator.h"
+#include "ImpulseSample.h"
 
-#define IMPULSE_QUEUE_SIZE (CONFIG_GPIO_IMPULSE_QUEUE_SIZE * CONFIG_ORM_IMPULSES_PER_REV)
+#define IMPULSE_QUEUE_SIZE (CONFIG_GPIO_IMPULSE_QUEUE_SIZE * ORM_ENGINE_IMPULSES_PER_REV)
 
+/**
+ * @brief Impulse sensors of every rower on the board, and the physics thread.
+ *
+ * Rower i has its own sensor (devicetree alias 'impulse-sensor' for rower 0,
+ * 'impulse-sensor-i' after it), interrupt context, queue and engine. One
+ * physics thread serves all of them, one impulse at a time in round robin.
+ * When a queue is full the ISR counts the impulses it cannot queue, and the
+ * next one that fits carries them to the engine (see ImpulseSample.h).
+ */
 class GpioTimerService {
 public:
-    explicit GpioTimerService(RowingEngine &eng, const RowingSettings &rs);
+    GpioTimerService(RowingEngine<> (&engines)[CONFIG_ORM_ROWER_COUNT], const DefaultRowingSettings<> &rs);
     int init();
-    void handleInterrupt();
+    // Interrupts of one rower, or of all of them
+    void pause(int rower);
+    void resume(int rower);
     void pause();
     void resume();
     struct k_thread* getPhysicsThread();
 
 private:
-    const RowingSettings &settings;
-    RowingEngine &engine;
+    const DefaultRowingSettings<> &settings;
 
     uint32_t minCycles;
-    // GPIO structs
-    struct gpio_dt_spec sensorSpec;
-    struct gpio_callback pinCbData;
 
-    // Timing State
-    uint32_t lastCycleTime;
-    bool isFirstPulse;
+    // Everything the interrupt of one sensor touches. The ISR gets back
+    // to it from its gpio_callback, so sensors never share state.
+    struct Sensor {
+        GpioTimerService *service;
+        RowingEngine<> *engine;
+        // GPIO structs
+        struct gpio_dt_spec spec;
+        struct gpio_callback pinCbData;
 
-    // IPC: Message Queue
-    struct k_msgq impulseQueue;
-    char __aligned(8) impulseQueueBuffer[IMPULSE_QUEUE_SIZE * sizeof(uint32_t)];
+        // Timing State
+        uint32_t lastCycleTime;
+        bool isFirstPulse;
+        ImpulseDecimator<> decimator;
+        ImpulseLossCounter losses;
+
+        // Pause detection, physics thread only: uptime of the last impulse
+        // taken from the queue, and whether the engine is waiting for the next
+        int64_t lastImpulseMs;
+        bool moving;
+
+        // IPC: Message Queue
+        struct k_msgq impulseQueue;
+        char __aligned(8) impulseQueueBuffer[IMPULSE_QUEUE_SIZE * sizeof(ImpulseSample)];
+    };
+    Sensor sensors[CONFIG_ORM_ROWER_COUNT];
+
+    // One count per queued impulse, over all sensors
+    struct k_sem impulseSignal;
 
     // THREAD DATA
     // We keep the struct here, but the STACK will be defined in the .cpp file
@@ -39,6 +69,10 @@ private:
 
     // The Loop Function
     void physicsLoop();
+    // Time left until the first moving rower runs out of impulses
+    k_timeout_t nextPauseTimeout(int64_t now);
+    void pauseStoppedRowers(int64_t now);
+    void handleInterrupt(Sensor &sensor);
 
     // Static entry points
     static void physicsThreadEntryPoint(void* p1, void* p2, void* p3);
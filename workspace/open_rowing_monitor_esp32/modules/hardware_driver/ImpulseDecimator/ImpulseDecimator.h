@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <zephyr/kernel.h>
+
+// Impulses per revolution the engine sees: sensor impulses over the decimation
+#define ORM_ENGINE_IMPULSES_PER_REV (CONFIG_ORM_IMPULSES_PER_REV / CONFIG_ORM_IMPULSE_DECIMATION)
+
+/**
+ * @brief Fixed-angle binning of sensor impulses.
+ *
+ * Runs where the impulses are timed (ISR or input thread). It sums the
+ * cycle deltas of N consecutive impulses and hands out one delta per bin,
+ * so an encoder disc with hundreds of slots costs one queue entry and one
+ * engine call per N slots. Each bin covers the same flywheel angle, which
+ * is what the engine assumes of an impulse (angularDisplacementPerImpulse
+ * accounts for N). With N = 1 every impulse passes straight through.
+ */
+template<uint32_t N = CONFIG_ORM_IMPULSE_DECIMATION>
+class ImpulseDecimator {
+    static_assert(N >= 1, "Decimation must be at least 1");
+
+    uint32_t binCycles = 0;
+    uint32_t binImpulses = 0;
+public:
+    // Adds one impulse; true when it completes a bin, binDelta is then its cycles
+    bool push(uint32_t deltaCycles, uint32_t &binDelta) {
+        if (N == 1) {
+            binDelta = deltaCycles;
+            return true;
+        }
+        binCycles += deltaCycles;
+        if (++binImpulses < N) return false;
+        binDelta = binCycles;
+        binCycles = 0;
+        binImpulses = 0;
+        return true;
+    }
+
+    // Drops a partial bin (after a pause, the next impulse starts a new one)
+    void reset() {
+        binCycles = 0;
+        binImpulses = 0;
+    }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+
+// One impulse queue entry, from where impulses are timed to the physics thread
+struct ImpulseSample {
+    uint32_t deltaCycles;   // Since the last delivered sample, lost impulses included
+    uint32_t missed;        // Impulses lost to a full queue just before this one
+};
+
+/**
+ * @brief Loss accounting on the sending side of the impulse queue.
+ *
+ * offer() builds the next sample and hands it to put (k_msgq_put with
+ * K_NO_WAIT in the services). If the queue is full, the impulse is booked
+ * as lost: its cycles and the count ride along with the next sample that
+ * gets through, and RowingEngine::handleRotationImpulse(deltaCycles, missed)
+ * spreads them over the missing impulses. Time and angle are kept, only
+ * the shape of the flywheel curve inside the gap is lost.
+ * * An impulse outside the gate of the engine (setGate) is never part of a
+ * gap: the engine would drop it, time included, so it is sent or lost on
+ * its own. A bounce then costs the same time whether the queue was full
+ * or not.
+ * * Runs in the ISR: no locks, O(1). Works on bins when a decimator sits
+ * in front of it.
+ */
+class ImpulseLossCounter {
+    uint32_t lostCycles = 0;
+    uint32_t lostImpulses = 0;
+    uint32_t totalLost = 0;
+    uint32_t minimumCycles = 0;
+    uint32_t maximumCycles = UINT32_MAX;
+public:
+    // The impulses the engine accepts (RowingEngine::getMinimumImpulseCycles()
+    // and getMaximumImpulseCycles()), taken again at every resume
+    void setGate(uint32_t minimum, uint32_t maximum) {
+        minimumCycles = minimum;
+        maximumCycles = maximum;
+    }
+
+    // True when put took the sample
+    template<typename F>
+    bool offer(uint32_t deltaCycles, F &&put) {
+        if (deltaCycles > maximumCycles) {
+            // The engine pauses before this one: the gap ends with the session part
+            reset();
+        }
+        bool gated = deltaCycles < minimumCycles || deltaCycles > maximumCycles;
+        uint32_t carriedCycles = gated ? 0 : lostCycles;
+        // Saturates instead of wrapping: a gap that long is a pause anyway
+        uint32_t cycles = (deltaCycles > UINT32_MAX - carriedCycles) ? UINT32_MAX : deltaCycles + carriedCycles;
+        ImpulseSample sample{cycles, gated ? 0 : lostImpulses};
+        if (put(sample)) {
+            if (!gated) {
+                lostCycles = 0;
+                lostImpulses = 0;
+            }
+            return true;
+        }
+        totalLost++;
+        if (!gated) {
+            lostCycles = cycles;
+            lostImpulses++;
+        }
+        return false;
+    }
+
+    // Impulses the queue refused since start
+    uint32_t getTotalLost() const { return totalLost; }
+
+    // Forgets a pending gap (after a pause, the next impulse starts fresh)
+    void reset() {
+        lostCycles = 0;
+        lostImpulses = 0;
+    }
+};
@@ -29,7 +29,7 @@ INPUT_CALLBACK_DEFINE(NULL,
 //                       input_bridge_callback,
 //                       nullptr);
 
-InputTimerService::InputTimerService(RowingEngine& eng)
+InputTimerService::InputTimerService(RowingEngine<>& eng)
     : m_engine(eng),
       lastCycleTime(0),
       isFirstPulse(true),
@@ -37,7 +37,7 @@ InputTimerService::InputTimerService(RowingEngine& eng)
 
           instance = this;
 
-          k_msgq_init(&impulseQueue, impulseQueueBuffer, sizeof(uint32_t), IMPULSE_QUEUE_SIZE);
+          k_msgq_init(&impulseQueue, impulseQueueBuffer, sizeof(ImpulseSample), IMPULSE_QUEUE_SIZE);
 
           k_thread_create(&physicsThreadData,
                           physicsThreadStack,
@@ -62,6 +62,9 @@ void InputTimerService::pause() {
 void InputTimerService::resume() {
     isPaused = false;
     isFirstPulse = true; // Reset state
+    decimator.reset();
+    losses.reset();
+    losses.setGate(m_engine.getMinimumImpulseCycles(), m_engine.getMaximumImpulseCycles());
     LOG_INF("Physics Engine RESUMED");
 }
 
@@ -71,14 +74,19 @@ void InputTimerService::physicsThreadEntryPoint(void* p1, void* p2, void* p3) {
 }
 
 void InputTimerService::physicsLoop() {
-    uint32_t deltaCycles;
+    ImpulseSample sample;
+    bool moving = false;
     LOG_INF("Physics loop thread started");
 
     while (true) {
-        if (k_msgq_get(&impulseQueue, &deltaCycles, K_FOREVER) == 0) {
-
-            double dt = (double)deltaCycles / (double)sys_clock_hw_cycles_per_sec();
-            m_engine.handleRotationImpulse(dt);
+        // While the flywheel turns, a quiet queue means it stopped: pause the engine
+        k_timeout_t timeout = moving ? K_MSEC(m_engine.impulseTimeoutMs()) : K_FOREVER;
+        if (k_msgq_get(&impulseQueue, &sample, timeout) == 0) {
+            m_engine.handleRotationImpulse(sample.deltaCycles, sample.missed);
+            moving = true;
+        } else if (moving) {
+            m_engine.handleImpulseTimeout();
+            moving = false;
         }
     }
 }
@@ -114,5 +122,11 @@ void InputTimerService::handleInputEvent(struct input_event *evt) {
     uint32_t deltaCycles = currentCycles - lastCycleTime;
     lastCycleTime = currentCycles;
 
-    k_msgq_put(&impulseQueue, &deltaCycles, K_NO_WAIT);
+    // High-resolution discs: one entry per bin of impulses
+    if (!decimator.push(deltaCycles, deltaCycles)) return;
+
+    // A full queue loses the impulse but not its time, the next one carries both
+    losses.offer(deltaCycles, [this](const ImpulseSample &sample) {
+        return k_msgq_put(&impulseQueue, &sample, K_NO_WAIT) == 0;
+    });
 }
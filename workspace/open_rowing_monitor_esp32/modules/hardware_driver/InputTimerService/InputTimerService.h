@@ -3,8 +3,10 @@
 #include <zephyr/kernel.h>
 #include <zephyr/input/input.h>
 #include "RowingEngine.h"
+#include "ImpulseDecimator.h"
+#include "ImpulseSample.h"
 
-#define IMPULSE_QUEUE_SIZE (CONFIG_INPUT_IMPULSE_QUEUE_SIZE * CONFIG_ORM_IMPULSES_PER_REV)
+#define IMPULSE_QUEUE_SIZE (CONFIG_INPUT_IMPULSE_QUEUE_SIZE * ORM_ENGINE_IMPULSES_PER_REV)
 
 /**
  * @brief Input-based Timer Service for Rowing Monitor
@@ -18,23 +20,25 @@
  */
 class InputTimerService {
 public:
-    explicit InputTimerService(RowingEngine& engine);
+    explicit InputTimerService(RowingEngine<>& engine);
     int init();
     void pause();
     void resume();
 
     void handleInputEvent(struct input_event *evt);
 private:
-    RowingEngine& m_engine;
+    RowingEngine<>& m_engine;
 
     // Timing State
     uint32_t lastCycleTime;
     bool isFirstPulse;
     bool isPaused;
+    ImpulseDecimator<> decimator;
+    ImpulseLossCounter losses;
 
     // Impulse queue
     struct k_msgq impulseQueue;
-    char __aligned(8) impulseQueueBuffer[IMPULSE_QUEUE_SIZE * sizeof(uint32_t)];
+    char __aligned(8) impulseQueueBuffer[IMPULSE_QUEUE_SIZE * sizeof(ImpulseSample)];
 
     struct k_thread physicsThreadData;
 
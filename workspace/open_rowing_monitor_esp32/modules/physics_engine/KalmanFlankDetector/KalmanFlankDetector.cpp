@@ -0,0 +1,240 @@
+#include "KalmanFlankDetector.h"
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(KalmanFlankDetector, LOG_LEVEL_DBG);
+
+template<typename T, typename S>
+KalmanFlankDetector<T, S>::KalmanFlankDetector(const S &rowerSettings, uint32_t cyclesPerSec)
+    : settings(rowerSettings),
+      clock(cyclesPerSec),
+      defaultCycles(clock.toCycles(rowerSettings.maximumTimeBetweenSteps)) {
+
+    T angleNoise = T((double)CONFIG_ORM_KALMAN_ANGLE_NOISE_X10000 / 10000.0);
+    measurementVariance = angleNoise * angleNoise;
+    jerkVariance = T(CONFIG_ORM_KALMAN_JERK_NOISE) * T(CONFIG_ORM_KALMAN_JERK_NOISE);
+    gateSquared = T(CONFIG_ORM_KALMAN_GATE * CONFIG_ORM_KALMAN_GATE);
+
+    maxNumberOfSequentialRejections = (settings.smoothing >= 2 ? settings.smoothing : 2);
+    rejected = 0;
+    reset();
+}
+
+template<typename T, typename S>
+void KalmanFlankDetector<T, S>::reset() {
+    resetFilter();
+
+    T defaultVelocity = state[1];
+    for (int i = 0; i < KALMAN_FLANK_ARRAY_SIZE; i++) {
+        samples[i].dirtyCycles = defaultCycles;
+        samples[i].angularVelocity = defaultVelocity;
+        samples[i].angularAcceleration = T(0);
+        samples[i].accelerating = false;
+        samples[i].decelerating = false;
+    }
+    head = 0;
+    numberOfAccelerating = 0;
+    numberOfDecelerating = 0;
+    dirtyCycleSum = (uint64_t)defaultCycles * (flankLength() + 1);
+}
+
+template<typename T, typename S>
+void KalmanFlankDetector<T, S>::applySettings(const S &rowerSettings) {
+    settings = rowerSettings;
+    defaultCycles = clock.toCycles(settings.maximumTimeBetweenSteps);
+    maxNumberOfSequentialRejections = (settings.smoothing >= 2 ? settings.smoothing : 2);
+
+    // Recount the window state over the new length
+    const int len = flankLength();
+    numberOfAccelerating = 0;
+    numberOfDecelerating = 0;
+    dirtyCycleSum = 0;
+    for (int age = 0; age <= len; age++) {
+        const FlankSample &sample = sampleAt(age);
+        if (age < len && sample.accelerating) numberOfAccelerating++;
+        if (age < len && sample.decelerating) numberOfDecelerating++;
+        dirtyCycleSum += sample.dirtyCycles;
+    }
+}
+
+template<typename T, typename S>
+void KalmanFlankDetector<T, S>::resetFilter() {
+    // Start at rest-ish: the slowest plausible speed, no acceleration, wide uncertainty
+    state[0] = T(0);
+    state[1] = settings.angularDisplacementPerStep / settings.maximumTimeBetweenSteps;
+    state[2] = T(0);
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            covariance[i][j] = T(0);
+        }
+    }
+    covariance[0][0] = measurementVariance;
+    covariance[1][1] = T(100) * T(100);
+    covariance[2][2] = T(1000) * T(1000);
+
+    pendingTime = T(0);
+    numberOfSequentialRejections = 0;
+}
+
+// Predict over dt, then update with "one magnet further". Returns false if gated out.
+template<typename T, typename S>
+bool KalmanFlankDetector<T, S>::filterImpulse(T dt) {
+    // 1. Predict: constant acceleration over dt
+    const T halfDt2 = dt * dt * T(0.5);
+    const T F[N][N] = {
+        {T(1), dt, halfDt2},
+        {T(0), T(1), dt},
+        {T(0), T(0), T(1)},
+    };
+
+    T predicted[N];
+    predicted[0] = state[0] + dt * state[1] + halfDt2 * state[2];
+    predicted[1] = state[1] + dt * state[2];
+    predicted[2] = state[2];
+
+    // F * P
+    T fp[N][N];
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            T sum = T(0);
+            for (int k = i; k < N; k++) { // F is upper triangular
+                sum += F[i][k] * covariance[k][j];
+            }
+            fp[i][j] = sum;
+        }
+    }
+
+    // (F * P) * F^T + Q. Q of white jerk noise, multiplied out from q * dt
+    // so no power of dt underflows the fixed-point resolution.
+    const T qDt = jerkVariance * dt;
+    const T qDt2 = qDt * dt;
+    const T qDt3 = qDt2 * dt;
+    const T qDt4 = qDt3 * dt;
+    const T qDt5 = qDt4 * dt;
+    const T Q[N][N] = {
+        {qDt5 / T(20), qDt4 / T(8), qDt3 / T(6)},
+        {qDt4 / T(8), qDt3 / T(3), qDt2 / T(2)},
+        {qDt3 / T(6), qDt2 / T(2), qDt},
+    };
+    T predictedCovariance[N][N];
+    for (int i = 0; i < N; i++) {
+        for (int j = i; j < N; j++) {
+            T sum = Q[i][j];
+            for (int k = j; k < N; k++) { // F^T is lower triangular
+                sum += fp[i][k] * F[j][k];
+            }
+            predictedCovariance[i][j] = sum;
+            predictedCovariance[j][i] = sum;
+        }
+    }
+
+    // 2. Gate: the magnet should be one angle step further
+    const T innovation = settings.angularDisplacementPerStep - predicted[0];
+    const T innovationVariance = predictedCovariance[0][0] + measurementVariance;
+    if (innovation * innovation > gateSquared * innovationVariance &&
+        numberOfSequentialRejections < maxNumberOfSequentialRejections) {
+        return false;
+    }
+
+    // 3. Update
+    T gain[N];
+    for (int i = 0; i < N; i++) {
+        gain[i] = predictedCovariance[i][0] / innovationVariance;
+    }
+    for (int i = 0; i < N; i++) {
+        state[i] = predicted[i] + gain[i] * innovation;
+    }
+    for (int i = 0; i < N; i++) {
+        for (int j = i; j < N; j++) {
+            T value = predictedCovariance[i][j] - gain[i] * predictedCovariance[0][j];
+            covariance[i][j] = value;
+            covariance[j][i] = value;
+        }
+    }
+
+    // Angle relative to the magnet just seen, so it stays small
+    state[0] -= settings.angularDisplacementPerStep;
+    return true;
+}
+
+template<typename T, typename S>
+void KalmanFlankDetector<T, S>::pushValue(T dataPoint, uint32_t cycles) {
+    const int len = flankLength();
+
+    // 1. Retire the oldest sample from the window
+    const FlankSample &leaving = sampleAt(len - 1);
+    if (leaving.accelerating) numberOfAccelerating--;
+    if (leaving.decelerating) numberOfDecelerating--;
+    dirtyCycleSum -= sampleAt(len).dirtyCycles;
+
+    head = (head + 1 == KALMAN_FLANK_ARRAY_SIZE) ? 0 : head + 1;
+    FlankSample &newest = samples[head];
+    newest.dirtyCycles = cycles;
+    dirtyCycleSum += cycles;
+
+    // 2. Filter. A rejected impulse (bounce) leaves the estimate alone and
+    // hands its time to the next impulse. After a gap longer than any
+    // rowing impulse the old state means nothing (and q * dt would
+    // outgrow the fixed-point range): start over.
+    T elapsed = pendingTime + dataPoint;
+    if (elapsed > settings.maximumTimeBetweenSteps) {
+        resetFilter();
+    } else if (filterImpulse(elapsed)) {
+        pendingTime = T(0);
+        numberOfSequentialRejections = 0;
+    } else {
+        LOG_DBG("Kalman gate: rejected %f", static_cast<double>(dataPoint));
+        pendingTime += dataPoint;
+        numberOfSequentialRejections++;
+        rejected++;
+    }
+
+    // 3. Add the new estimate to the window
+    newest.angularVelocity = state[1];
+    newest.angularAcceleration = state[2];
+    newest.accelerating = (state[2] > T(0));
+    newest.decelerating = (state[2] < unpoweredThreshold());
+    if (newest.accelerating) numberOfAccelerating++;
+    if (newest.decelerating) numberOfDecelerating++;
+}
+
+template<typename T, typename S>
+bool KalmanFlankDetector<T, S>::isFlywheelPowered() {
+    int numberOfErrors = flankLength() - numberOfAccelerating;
+    return (numberOfErrors <= settings.numberOfErrorsAllowed);
+}
+
+template<typename T, typename S>
+bool KalmanFlankDetector<T, S>::isFlywheelUnpowered() {
+    int numberOfErrors = flankLength() - numberOfDecelerating;
+    return (numberOfErrors <= settings.numberOfErrorsAllowed);
+}
+
+template<typename T, typename S>
+uint64_t KalmanFlankDetector<T, S>::cyclesToBeginOfFlank() {
+    return dirtyCycleSum;
+}
+
+template<typename T, typename S>
+T KalmanFlankDetector<T, S>::noImpulsesToBeginFlank() {
+    return T(flankLength());
+}
+
+template<typename T, typename S>
+T KalmanFlankDetector<T, S>::impulseLengthAtBeginFlank() {
+    T velocity = sampleAt(flankLength()).angularVelocity;
+    return (velocity > T(0)) ? settings.angularDisplacementPerStep / velocity : settings.maximumTimeBetweenSteps;
+}
+
+template<typename T, typename S>
+T KalmanFlankDetector<T, S>::accelerationAtBeginOfFlank() {
+    return sampleAt(flankLength() - 1).angularAcceleration;
+}
+
+// Explicit instantiations for every arithmetic type the engine can be built with,
+// with both settings types
+template class KalmanFlankDetector<double, RowingSettings<double>>;
+template class KalmanFlankDetector<float, RowingSettings<float>>;
+template class KalmanFlankDetector<Fixed, RowingSettings<Fixed>>;
+template class KalmanFlankDetector<double, StaticRowingSettings<double>>;
+template class KalmanFlankDetector<float, StaticRowingSettings<float>>;
+template class KalmanFlankDetector<Fixed, StaticRowingSettings<Fixed>>;
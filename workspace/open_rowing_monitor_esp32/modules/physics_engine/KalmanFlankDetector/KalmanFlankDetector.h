@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <zephyr/kernel.h>
+
+#include "RowingSettings.h"
+
+// Largest flank the Kconfig flank length can ask for
+#define KALMAN_FLANK_ARRAY_SIZE (CONFIG_ORM_FLANK_LENGTH + 1)
+
+/**
+ * @brief Flank detector on a Kalman filter of the flywheel state.
+ * * Same interface as MovingFlankDetector. The state is angle, angular
+ * velocity and angular acceleration under a constant-acceleration model
+ * (white jerk noise, CONFIG_ORM_KALMAN_JERK_NOISE). Every impulse is one
+ * angle measurement of angularDisplacementPerStep, with a magnet
+ * placement error of CONFIG_ORM_KALMAN_ANGLE_NOISE_X10000.
+ * * Replaces the bounds check and change limiter: an impulse whose
+ * innovation lies outside CONFIG_ORM_KALMAN_GATE sigmas is taken as a
+ * bounce, and its time is carried into the next impulse. After more than
+ * `smoothing` rejections in a row the filter trusts the magnets again.
+ * * Powered: the estimated acceleration stayed above 0 for the flank.
+ * Unpowered: below naturalDeceleration when that is negative, else
+ * below 0. numberOfErrorsAllowed impulses of the flank may disagree.
+ * * Everything is a fixed 3x3 (no allocation). The angle is kept relative
+ * to the last magnet so it never grows.
+ */
+template<typename T = PhysicsScalar, typename S = DefaultRowingSettings<T>>
+class KalmanFlankDetector {
+private:
+    static constexpr int N = 3; // angle, angular velocity, angular acceleration
+
+    S settings;
+
+    T state[N];
+    T covariance[N][N];
+    T measurementVariance;
+    T jerkVariance;
+    T gateSquared;
+
+    T pendingTime; // dt of rejected impulses, added to the next one
+    int numberOfSequentialRejections;
+    int maxNumberOfSequentialRejections;
+    uint32_t rejected;
+
+    // Per impulse of the flank: raw length in timer cycles and the estimate after it
+    struct FlankSample {
+        uint32_t dirtyCycles;
+        T angularVelocity;
+        T angularAcceleration;
+        bool accelerating;
+        bool decelerating;
+    };
+    FlankSample samples[KALMAN_FLANK_ARRAY_SIZE];
+    int head;
+
+    // Running state of the window (the newest flankLength + 1 samples)
+    int numberOfAccelerating; // over the newest flankLength samples
+    int numberOfDecelerating;
+    uint64_t dirtyCycleSum;
+
+    // maximumTimeBetweenSteps in timer cycles, what reset() fills the flank with
+    // (clock converts it again when the settings change)
+    CycleClock<T> clock;
+    uint32_t defaultCycles;
+
+    // settings.flankLength clamped to the buffer (folds to a constant with StaticRowingSettings)
+    int flankLength() const {
+        int len = settings.flankLength;
+        if (len >= KALMAN_FLANK_ARRAY_SIZE) len = KALMAN_FLANK_ARRAY_SIZE - 1;
+        return (len < 1) ? 1 : len;
+    }
+
+    const FlankSample &sampleAt(int age) const {
+        int idx = head - age;
+        if (idx < 0) idx += KALMAN_FLANK_ARRAY_SIZE;
+        return samples[idx];
+    }
+
+    T unpoweredThreshold() const {
+        return (settings.naturalDeceleration < T(0)) ? settings.naturalDeceleration : T(0);
+    }
+
+    void resetFilter();
+    bool filterImpulse(T dt);
+
+public:
+    // The engine takes angular velocity and acceleration from the filter
+    static constexpr bool estimatesState = true;
+
+    explicit KalmanFlankDetector(const S &rowerSettings, uint32_t cyclesPerSec = sys_clock_hw_cycles_per_sec());
+
+    // Back to the state of a stopped flywheel, e.g. after a pause.
+    // rejectedImpulses() keeps counting.
+    void reset();
+
+    // New settings between two impulses. The filter state carries on; the
+    // flank keeps its last KALMAN_FLANK_ARRAY_SIZE estimates, so a new
+    // flank length is counted over real history.
+    void applySettings(const S &rowerSettings);
+
+    // dt in seconds, and the same impulse in timer cycles for the flank timing
+    void pushValue(T dataPoint, uint32_t cycles);
+
+    // State Checks
+    bool isFlywheelPowered();
+    bool isFlywheelUnpowered();
+
+    // Getters
+    uint64_t cyclesToBeginOfFlank();
+    T noImpulsesToBeginFlank();
+    T impulseLengthAtBeginFlank();
+    T accelerationAtBeginOfFlank();
+
+    // Current filter estimate
+    T angularVelocity() const { return state[1]; }
+    T angularAcceleration() const { return state[2]; }
+    uint32_t rejectedImpulses() const { return rejected; }
+};
@@ -3,40 +3,17 @@
 
 LOG_MODULE_REGISTER(MovingAverager, LOG_LEVEL_DBG);
 
-MovingAverager::MovingAverager(int requestedLength, double initValue) {
+int movingAveragerClampLength(int requestedLength, int capacity) {
     // Safety Check:
     // If logic somewhere requests a size larger than we allocated,
     // we clamp it to prevent memory corruption (buffer overflow).
-    if (requestedLength > MAX_AVERAGER_CAPACITY) {
-        LOG_WRN("Requested size %d > Max Capacity %d. Clamping.", requestedLength, MAX_AVERAGER_CAPACITY);
-        length = MAX_AVERAGER_CAPACITY;
-    } else {
-        length = requestedLength;
+    if (requestedLength > capacity) {
+        LOG_WRN("Requested size %d > Max Capacity %d. Clamping.", requestedLength, capacity);
+        return capacity;
     }
-    reset(initValue);
-}
-
-void MovingAverager::pushValue(double dataPoint) {
-    // Standard shift logic
-    currAve = currAve+((dataPoint-dataPoints[length-1])/length);
-    for (int i = length - 1; i > 0; i--) {
-        dataPoints[i] = dataPoints[i - 1];
-    }
-    dataPoints[0] = dataPoint;
-}
-
-void MovingAverager::replaceLastPushedValue(double dataPoint) {
-    currAve = currAve+((dataPoint-dataPoints[0])/length);
-    dataPoints[0] = dataPoint;
-}
-
-double MovingAverager::getAverage() {
-    return currAve;
-}
-
-void MovingAverager::reset(double initValue) {
-    for (int i = 0; i < length; i++) {
-        dataPoints[i] = initValue;
+    if (requestedLength < 1) {
+        LOG_WRN("Requested size %d < 1. Clamping.", requestedLength);
+        return 1;
     }
-    currAve = initValue;
+    return requestedLength;
 }
@@ -1,41 +1,93 @@
 #pragma once
-#include <algorithm>
+#include "PhysicsScalar.h"
 #include <zephyr/kernel.h> // Required to see CONFIG_ macros
 
-// ----------------------------------------------------------------------
-// Calculate the exact memory needed at Compile Time
-// ----------------------------------------------------------------------
-
-// 1. Determine the size needed for Drag Factor (if enabled)
-#ifdef CONFIG_ORM_AUTO_ADJUST_DRAG_FACTOR
-    #define _DRAG_SIZE CONFIG_ORM_DAMPING_CONSTANT_SMOOTING
-#else
-    #define _DRAG_SIZE 0
-#endif
-
-// 2. Determine the size needed for Flank Detection
-#define _FLANK_SIZE CONFIG_ORM_SMOOTHING
-
-// 3. Set the Capacity to the LARGER of the two
-#if _DRAG_SIZE > _FLANK_SIZE
-    #define MAX_AVERAGER_CAPACITY _DRAG_SIZE
-#else
-    #define MAX_AVERAGER_CAPACITY _FLANK_SIZE
-#endif
-
-// ----------------------------------------------------------------------
+// Clamps a requested window length to the capacity N (logs if it had to).
+int movingAveragerClampLength(int requestedLength, int capacity);
 
+/**
+ * @brief Moving average over the last `length` values, length <= N.
+ * * N is the compile-time capacity, so every instance is exactly as big as
+ * its Kconfig setting needs (CONFIG_ORM_SMOOTHING for the flank detector,
+ * CONFIG_ORM_DAMPING_CONSTANT_SMOOTING for the drag factor).
+ * * Values live in a circular buffer with a head index, so a push is O(1).
+ * The average is a running sum times 1/length; the sum is re-summed
+ * from the buffer once per lap so float/double rounding cannot build up
+ * over a long session.
+ */
+template<int N, typename T = PhysicsScalar>
 class MovingAverager {
+    static_assert(N >= 1, "MovingAverager needs a capacity of at least 1");
+
 private:
-    // Now this array is exactly as big as it needs to be, and no bigger.
-    double dataPoints[MAX_AVERAGER_CAPACITY];
+    T dataPoints[N];
     int length;
-    double currAve;
+    int head; // dataPoints[head] is the last pushed value
+    T inverseLength; // 1/length, so an average costs a multiply instead of a divide
+    T sum;
+
+    void resum() {
+        T total = T(0);
+        for (int i = 0; i < length; i++) {
+            total += dataPoints[i];
+        }
+        sum = total;
+    }
 
 public:
-    MovingAverager(int requestedLength, double initValue);
-    void pushValue(double dataPoint);
-    void replaceLastPushedValue(double dataPoint);
-    double getAverage();
-    void reset(double initValue);
+    MovingAverager(int requestedLength, T initValue)
+        : length(movingAveragerClampLength(requestedLength, N)),
+          inverseLength(T(1) / T(length)) {
+        reset(initValue);
+    }
+
+    void pushValue(T dataPoint) {
+        head = (head + 1 == length) ? 0 : head + 1;
+        T oldest = dataPoints[head];
+        dataPoints[head] = dataPoint;
+        if (head == 0) {
+            resum();
+        } else {
+            sum += dataPoint - oldest;
+        }
+    }
+
+    // Overwrites the value of the last pushValue() (used by the change limiter)
+    void replaceLastPushedValue(T dataPoint) {
+        sum += dataPoint - dataPoints[head];
+        dataPoints[head] = dataPoint;
+    }
+
+    T getAverage() const {
+        return sum * inverseLength;
+    }
+
+    // New window length (clamped like the constructor's), keeping the newest
+    // values; a longer window is padded with the current average. O(N).
+    void setLength(int requestedLength) {
+        int newLength = movingAveragerClampLength(requestedLength, N);
+        if (newLength == length) return;
+
+        T newest[N];
+        T average = getAverage();
+        for (int age = 0; age < newLength; age++) {
+            newest[age] = (age < length) ? dataPoints[(head - age + length) % length] : average;
+        }
+        // Oldest first, so the last pushed value ends up at head
+        for (int i = 0; i < newLength; i++) {
+            dataPoints[i] = newest[newLength - 1 - i];
+        }
+        length = newLength;
+        inverseLength = T(1) / T(length);
+        head = length - 1;
+        resum();
+    }
+
+    void reset(T initValue) {
+        for (int i = 0; i < length; i++) {
+            dataPoints[i] = initValue;
+        }
+        head = 0;
+        resum();
+    }
 };
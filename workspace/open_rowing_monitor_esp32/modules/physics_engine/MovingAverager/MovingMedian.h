@@ -0,0 +1,114 @@
+#pragma once
+#include "MovingAverager.h" // movingAveragerClampLength()
+#include "PhysicsScalar.h"
+
+/**
+ * @brief Moving median over the last `length` values, length <= N.
+ * * Same use as MovingAverager, but one outlier cannot pull the result: it
+ * only ever moves the median by one rank.
+ * * The window is split into two binary heaps: `lower` (max-heap, the
+ * smaller half plus the middle value) and `upper` (min-heap). Every slot of
+ * the ring knows its heap position, so a push overwrites the oldest value
+ * in place and sifts it, then swaps the two heap tops if they crossed.
+ * Evict + insert is one O(log N) step; the heaps never change size.
+ */
+template<int N, typename T = PhysicsScalar>
+class MovingMedian {
+    static_assert(N >= 1, "MovingMedian needs a capacity of at least 1");
+
+private:
+    T dataPoints[N];
+    int length;
+    int head;          // dataPoints[head] is the last pushed value
+    int lower[N];      // slots, max-heap on their value
+    int upper[N];      // slots, min-heap on their value
+    int lowerSize;     // (length + 1) / 2
+    int upperSize;     // length / 2
+    int position[N];   // heap index of each slot: >= 0 in lower, -(index + 1) in upper
+
+    bool above(int a, int b, bool inLower) const {
+        // Heap order: parent "above" child (max-heap for lower, min-heap for upper)
+        return inLower ? (dataPoints[a] > dataPoints[b]) : (dataPoints[a] < dataPoints[b]);
+    }
+
+    void place(int *heap, bool inLower, int index, int slot) {
+        heap[index] = slot;
+        position[slot] = inLower ? index : -(index + 1);
+    }
+
+    void siftUp(int *heap, bool inLower, int index) {
+        int slot = heap[index];
+        while (index > 0) {
+            int parent = (index - 1) / 2;
+            if (!above(slot, heap[parent], inLower)) break;
+            place(heap, inLower, index, heap[parent]);
+            index = parent;
+        }
+        place(heap, inLower, index, slot);
+    }
+
+    void siftDown(int *heap, int size, bool inLower, int index) {
+        int slot = heap[index];
+        while (true) {
+            int child = 2 * index + 1;
+            if (child >= size) break;
+            if (child + 1 < size && above(heap[child + 1], heap[child], inLower)) child++;
+            if (!above(heap[child], slot, inLower)) break;
+            place(heap, inLower, index, heap[child]);
+            index = child;
+        }
+        place(heap, inLower, index, slot);
+    }
+
+public:
+    MovingMedian(int requestedLength, T initValue)
+        : length(movingAveragerClampLength(requestedLength, N)) {
+        reset(initValue);
+    }
+
+    void pushValue(T dataPoint) {
+        head = (head + 1 == length) ? 0 : head + 1;
+        dataPoints[head] = dataPoint;
+
+        // Restore the order of the heap the overwritten slot lives in
+        int pos = position[head];
+        if (pos >= 0) {
+            siftUp(lower, true, pos);
+            siftDown(lower, lowerSize, true, position[head]);
+        } else {
+            siftUp(upper, false, -pos - 1);
+            siftDown(upper, upperSize, false, -position[head] - 1);
+        }
+
+        // Only one value changed, so one swap of the tops restores lower <= upper
+        if (upperSize > 0 && dataPoints[lower[0]] > dataPoints[upper[0]]) {
+            int lowTop = lower[0];
+            int highTop = upper[0];
+            place(lower, true, 0, highTop);
+            place(upper, false, 0, lowTop);
+            siftDown(lower, lowerSize, true, 0);
+            siftDown(upper, upperSize, false, 0);
+        }
+    }
+
+    T getMedian() const {
+        if (upperSize == lowerSize) {
+            return (dataPoints[lower[0]] + dataPoints[upper[0]]) * T(0.5);
+        }
+        return dataPoints[lower[0]];
+    }
+
+    void reset(T initValue) {
+        lowerSize = (length + 1) / 2;
+        upperSize = length / 2;
+        for (int i = 0; i < length; i++) {
+            dataPoints[i] = initValue;
+            if (i < lowerSize) {
+                place(lower, true, i, i);
+            } else {
+                place(upper, false, i - lowerSize, i);
+            }
+        }
+        head = 0;
+    }
+};
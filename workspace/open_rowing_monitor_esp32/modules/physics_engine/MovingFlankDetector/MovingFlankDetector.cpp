@@ -3,50 +3,86 @@
 
 LOG_MODULE_REGISTER(MovingFlankDetector, LOG_LEVEL_DBG);
 
-MovingFlankDetector::MovingFlankDetector(RowingSettings rowerSettings)
+template<typename T, typename S, typename F>
+MovingFlankDetector<T, S, F>::MovingFlankDetector(const S &rowerSettings, uint32_t cyclesPerSec)
     : settings(rowerSettings),
-      movingAverage(rowerSettings.smoothing, rowerSettings.maximumTimeBetweenImpulses) {
+      filter(rowerSettings),
+      clock(cyclesPerSec),
+      defaultCycles(clock.toCycles(rowerSettings.maximumTimeBetweenSteps)) {
 
-    angularDisplacementPerImpulse = (2.0 * 3.14159265359) / settings.numOfImpulsesPerRevolution;
+    maxNumberOfSequentialCorrections = (settings.smoothing >= 2 ? settings.smoothing : 2);
+    reset();
+}
 
-    // Initialize arrays with loops instead of .assign()
-    double defaultVelocity = angularDisplacementPerImpulse / settings.maximumTimeBetweenImpulses;
+template<typename T, typename S, typename F>
+void MovingFlankDetector<T, S, F>::reset() {
+    filter.reset(settings.maximumTimeBetweenSteps);
+
+    // Initialize the ring with loops instead of .assign()
+    T defaultVelocity = settings.angularDisplacementPerStep / settings.maximumTimeBetweenSteps;
 
     for (int i = 0; i < FLANK_ARRAY_SIZE; i++) {
-        dirtyDataPoints[i] = settings.maximumTimeBetweenImpulses;
-        cleanDataPoints[i] = settings.maximumTimeBetweenImpulses;
-        angularVelocity[i] = defaultVelocity;
-        angularAcceleration[i] = 0.1;
+        samples[i].dirtyCycles = defaultCycles;
+        samples[i].clean = settings.maximumTimeBetweenSteps;
+        samples[i].angularVelocity = defaultVelocity;
+        samples[i].angularAcceleration = T(0.1);
     }
+    head = 0;
+
+    // All samples are equal, so every pair in the window is non-increasing
+    numberOfNonIncreasingPairs = flankLength();
+    dirtyCycleSum = (uint64_t)defaultCycles * (flankLength() + 1);
 
     numberOfSequentialCorrections = 0;
+}
+
+template<typename T, typename S, typename F>
+void MovingFlankDetector<T, S, F>::applySettings(const S &rowerSettings) {
+    settings = rowerSettings;
+    filter.applySettings(settings);
+    defaultCycles = clock.toCycles(settings.maximumTimeBetweenSteps);
     maxNumberOfSequentialCorrections = (settings.smoothing >= 2 ? settings.smoothing : 2);
+
+    // Recount the window state over the new length
+    const int len = flankLength();
+    numberOfNonIncreasingPairs = 0;
+    dirtyCycleSum = 0;
+    for (int age = 0; age <= len; age++) {
+        if (age < len && sampleAt(age).clean <= sampleAt(age + 1).clean) {
+            numberOfNonIncreasingPairs++;
+        }
+        dirtyCycleSum += sampleAt(age).dirtyCycles;
+    }
 }
 
-void MovingFlankDetector::pushValue(double dataPoint) {
-    // 1. Shift Data
-    // Use the Kconfig limit to prevent overflow
-    int len = settings.flankLength;
-    if (len >= FLANK_ARRAY_SIZE) len = FLANK_ARRAY_SIZE - 1;
-
-    for (int i = len; i > 0; i--) {
-        dirtyDataPoints[i] = dirtyDataPoints[i - 1];
-        cleanDataPoints[i] = cleanDataPoints[i - 1];
-        angularVelocity[i] = angularVelocity[i - 1];
-        angularAcceleration[i] = angularAcceleration[i - 1];
+template<typename T, typename S, typename F>
+void MovingFlankDetector<T, S, F>::pushValue(T dataPoint, uint32_t cycles) {
+    const int len = flankLength();
+
+    // 1. Retire the oldest sample and its pair from the window
+    const FlankSample &oldest = sampleAt(len);
+    if (sampleAt(len - 1).clean <= oldest.clean) {
+        numberOfNonIncreasingPairs--;
     }
-    dirtyDataPoints[0] = dataPoint;
+    dirtyCycleSum -= oldest.dirtyCycles;
+
+    head = (head + 1 == FLANK_ARRAY_SIZE) ? 0 : head + 1;
+    FlankSample &newest = samples[head];
+    const FlankSample &previous = sampleAt(1);
+
+    newest.dirtyCycles = cycles;
+    dirtyCycleSum += cycles;
 
     // 2. Noise Filter: Bounds Check
-    if (dataPoint < settings.minimumTimeBetweenImpulses || dataPoint > settings.maximumTimeBetweenImpulses) {
-        LOG_DBG("Noise Filter: Out of bounds %f", dataPoint);
-        dataPoint = cleanDataPoints[1];
+    if (dataPoint < settings.minimumTimeBetweenSteps || dataPoint > settings.maximumTimeBetweenSteps) {
+        LOG_DBG("Noise Filter: Out of bounds %f", static_cast<double>(dataPoint));
+        dataPoint = previous.clean;
     }
 
     // 3. Noise Filter: Change Limiter
-    movingAverage.pushValue(dataPoint);
-    double currentAverage = movingAverage.getAverage();
-    double previousClean = cleanDataPoints[1];
+    filter.pushValue(dataPoint);
+    T currentAverage = filter.getValue();
+    T previousClean = previous.clean;
 
     bool isPlausible = false;
     if (currentAverage > (settings.maximumDownwardChange * previousClean) &&
@@ -58,71 +94,88 @@ void MovingFlankDetector::pushValue(double dataPoint) {
         numberOfSequentialCorrections = 0;
     } else {
         if (numberOfSequentialCorrections <= maxNumberOfSequentialCorrections) {
-            movingAverage.replaceLastPushedValue(previousClean);
+            filter.replaceLastPushedValue(previousClean);
             numberOfSequentialCorrections++;
         }
     }
 
     // 4. Update Derived Metrics
-    cleanDataPoints[0] = movingAverage.getAverage();
-
-    if (cleanDataPoints[0] > 0) {
-        angularVelocity[0] = angularDisplacementPerImpulse / cleanDataPoints[0];
-        angularAcceleration[0] = (angularVelocity[0] - angularVelocity[1]) / cleanDataPoints[0];
-    } else {
-        angularVelocity[0] = 0;
-        angularAcceleration[0] = 0;
+    // A fit with negative weights can overshoot the inputs (e.g. out of the
+    // start-up ramp), keep it in the range the bounds check allows
+    newest.clean = filter.getValue();
+    if (newest.clean < settings.minimumTimeBetweenSteps) {
+        newest.clean = settings.minimumTimeBetweenSteps;
+    } else if (newest.clean > settings.maximumTimeBetweenSteps) {
+        newest.clean = settings.maximumTimeBetweenSteps;
     }
-}
 
-bool MovingFlankDetector::isFlywheelPowered() {
-    int numberOfErrors = 0;
-    int len = settings.flankLength;
-    if (len >= FLANK_ARRAY_SIZE) len = FLANK_ARRAY_SIZE - 1;
-
-    for (int i = len; i > 1; i--) {
-        if (cleanDataPoints[i] < cleanDataPoints[i - 1]) {
-            numberOfErrors++;
+    if (newest.clean > T(0)) {
+        newest.angularVelocity = settings.angularDisplacementPerStep / newest.clean;
+        if constexpr (F::hasDerivative) {
+            // w = angle / dt, so dw/dt = -w * (d dt / d impulse) / dt^2
+            newest.angularAcceleration = -newest.angularVelocity * filter.getSlope() / (newest.clean * newest.clean);
+        } else {
+            newest.angularAcceleration = (newest.angularVelocity - previous.angularVelocity) / newest.clean;
         }
+    } else {
+        newest.angularVelocity = T(0);
+        newest.angularAcceleration = T(0);
     }
-    if (cleanDataPoints[1] <= cleanDataPoints[0]) {
-        numberOfErrors++;
+
+    // 5. Add the new pair to the window
+    if (newest.clean <= previous.clean) {
+        numberOfNonIncreasingPairs++;
     }
-    return (numberOfErrors <= settings.numberOfErrorsAllowed);
 }
 
-bool MovingFlankDetector::isFlywheelUnpowered() {
-    int numberOfErrors = 0;
-    int len = settings.flankLength;
-    if (len >= FLANK_ARRAY_SIZE) len = FLANK_ARRAY_SIZE - 1;
-
-    for (int i = len; i > 0; i--) {
-        if (cleanDataPoints[i] >= cleanDataPoints[i - 1]) {
-            numberOfErrors++;
-        }
+template<typename T, typename S, typename F>
+bool MovingFlankDetector<T, S, F>::isFlywheelPowered() {
+    // Powered = clean dt strictly decreasing. Every pair that grew is an error,
+    // and the newest pair is also an error if it stayed equal.
+    int numberOfErrors = flankLength() - numberOfNonIncreasingPairs;
+    if (sampleAt(0).clean == sampleAt(1).clean) {
+        numberOfErrors++;
     }
     return (numberOfErrors <= settings.numberOfErrorsAllowed);
 }
 
-double MovingFlankDetector::timeToBeginOfFlank() {
-    double total = 0.0;
-    int len = settings.flankLength;
-    if (len >= FLANK_ARRAY_SIZE) len = FLANK_ARRAY_SIZE - 1;
+template<typename T, typename S, typename F>
+bool MovingFlankDetector<T, S, F>::isFlywheelUnpowered() {
+    // Unpowered = clean dt strictly increasing. Every pair that did not grow is an error.
+    return (numberOfNonIncreasingPairs <= settings.numberOfErrorsAllowed);
+}
 
-    for(int i = 0; i <= len; i++) {
-        total += dirtyDataPoints[i];
-    }
-    return total;
+template<typename T, typename S, typename F>
+uint64_t MovingFlankDetector<T, S, F>::cyclesToBeginOfFlank() {
+    return dirtyCycleSum;
 }
 
-double MovingFlankDetector::noImpulsesToBeginFlank() {
-    return (double)settings.flankLength;
+template<typename T, typename S, typename F>
+T MovingFlankDetector<T, S, F>::noImpulsesToBeginFlank() {
+    return T(flankLength());
 }
 
-double MovingFlankDetector::impulseLengthAtBeginFlank() {
-    return cleanDataPoints[settings.flankLength];
+template<typename T, typename S, typename F>
+T MovingFlankDetector<T, S, F>::impulseLengthAtBeginFlank() {
+    return sampleAt(flankLength()).clean;
 }
 
-double MovingFlankDetector::accelerationAtBeginOfFlank() {
-    return angularAcceleration[settings.flankLength - 1];
+template<typename T, typename S, typename F>
+T MovingFlankDetector<T, S, F>::accelerationAtBeginOfFlank() {
+    return sampleAt(flankLength() - 1).angularAcceleration;
 }
+
+// Explicit instantiations for every arithmetic type the engine can be built with,
+// with both settings types and both dt filters
+template class MovingFlankDetector<double, RowingSettings<double>, MovingAverageFilter<double>>;
+template class MovingFlankDetector<float, RowingSettings<float>, MovingAverageFilter<float>>;
+template class MovingFlankDetector<Fixed, RowingSettings<Fixed>, MovingAverageFilter<Fixed>>;
+template class MovingFlankDetector<double, StaticRowingSettings<double>, MovingAverageFilter<double>>;
+template class MovingFlankDetector<float, StaticRowingSettings<float>, MovingAverageFilter<float>>;
+template class MovingFlankDetector<Fixed, StaticRowingSettings<Fixed>, MovingAverageFilter<Fixed>>;
+template class MovingFlankDetector<double, RowingSettings<double>, SavitzkyGolayFilter<double>>;
+template class MovingFlankDetector<float, RowingSettings<float>, SavitzkyGolayFilter<float>>;
+template class MovingFlankDetector<Fixed, RowingSettings<Fixed>, SavitzkyGolayFilter<Fixed>>;
+template class MovingFlankDetector<double, StaticRowingSettings<double>, SavitzkyGolayFilter<double>>;
+template class MovingFlankDetector<float, StaticRowingSettings<float>, SavitzkyGolayFilter<float>>;
+template class MovingFlankDetector<Fixed, StaticRowingSettings<Fixed>, SavitzkyGolayFilter<Fixed>>;
@@ -6,37 +6,121 @@
 
 #include "MovingAverager.h"
 #include "RowingSettings.h"
+#include "SavitzkyGolayFilter.h"
 
 // Define the array size based on Kconfig.
 #define FLANK_ARRAY_SIZE (CONFIG_ORM_FLANK_LENGTH + 1)
 
+/**
+ * @brief Moving average of dt over settings.smoothing samples.
+ * No derivative: the detector differences consecutive smoothed samples.
+ */
+template<typename T = PhysicsScalar>
+class MovingAverageFilter {
+private:
+    MovingAverager<CONFIG_ORM_SMOOTHING, T> movingAverage;
+
+public:
+    static constexpr bool hasDerivative = false;
+    static constexpr const char *name = "moving average";
+
+    template<typename S>
+    explicit MovingAverageFilter(const S &settings)
+        : movingAverage(settings.smoothing, settings.maximumTimeBetweenSteps) {}
+
+    template<typename S>
+    void applySettings(const S &settings) { movingAverage.setLength(settings.smoothing); }
+
+    void pushValue(T dataPoint) { movingAverage.pushValue(dataPoint); }
+    void reset(T initValue) { movingAverage.reset(initValue); }
+    void replaceLastPushedValue(T dataPoint) { movingAverage.replaceLastPushedValue(dataPoint); }
+    T getValue() const { return movingAverage.getAverage(); }
+    T getSlope() const { return T(0); }
+};
+
+// dt smoothing filter of the detector, selected in Kconfig
+#ifdef CONFIG_ORM_FLANK_FILTER_SAVITZKY_GOLAY
+    template<typename T> using DefaultFlankFilter = SavitzkyGolayFilter<T>;
+#else
+    template<typename T> using DefaultFlankFilter = MovingAverageFilter<T>;
+#endif
+
+/**
+ * S is the settings type: RowingSettings<T> (runtime values, copied in) or
+ * StaticRowingSettings<T> (Kconfig constants, folded into the loops).
+ * F is the dt filter: MovingAverageFilter<T> or SavitzkyGolayFilter<T>.
+ * An impulse here is one analysis step of the engine (impulsesPerStep
+ * bins), hence the angle and time limits of a step.
+ */
+template<typename T = PhysicsScalar, typename S = DefaultRowingSettings<T>, typename F = DefaultFlankFilter<T>>
 class MovingFlankDetector {
 private:
-    RowingSettings settings;
-    MovingAverager movingAverage;
+    S settings;
+    F filter;
 
-    // Fixed-size arrays (Stack allocated). No std::vector!
-    double dirtyDataPoints[FLANK_ARRAY_SIZE];
-    double cleanDataPoints[FLANK_ARRAY_SIZE];
-    double angularVelocity[FLANK_ARRAY_SIZE];
-    double angularAcceleration[FLANK_ARRAY_SIZE];
+    // One impulse worth of data, kept together in the ring below
+    struct FlankSample {
+        uint32_t dirtyCycles;   // raw impulse length in timer cycles
+        T clean;
+        T angularVelocity;
+        T angularAcceleration;
+    };
+
+    // Circular buffer (Stack allocated). No std::vector, no shifting:
+    // samples[head] is the newest impulse, sampleAt(k) is k impulses older.
+    FlankSample samples[FLANK_ARRAY_SIZE];
+    int head;
+
+    // Running state of the window (the newest flankLength + 1 samples), so the
+    // queries below are O(1) whatever CONFIG_ORM_FLANK_LENGTH is.
+    int numberOfNonIncreasingPairs; // neighbour pairs where clean dt did not grow
+    uint64_t dirtyCycleSum;         // sum of the raw cycle counts in the window
 
-    double angularDisplacementPerImpulse;
     int numberOfSequentialCorrections;
     int maxNumberOfSequentialCorrections;
 
+    // maximumTimeBetweenSteps in timer cycles, what reset() fills the ring with
+    // (clock converts it again when the settings change)
+    CycleClock<T> clock;
+    uint32_t defaultCycles;
+
+    // settings.flankLength clamped to the buffer (folds to a constant with StaticRowingSettings)
+    int flankLength() const {
+        int len = settings.flankLength;
+        if (len >= FLANK_ARRAY_SIZE) len = FLANK_ARRAY_SIZE - 1;
+        return (len < 1) ? 1 : len;
+    }
+
+    const FlankSample &sampleAt(int age) const {
+        int idx = head - age;
+        if (idx < 0) idx += FLANK_ARRAY_SIZE;
+        return samples[idx];
+    }
+
 public:
-    explicit MovingFlankDetector(RowingSettings rowerSettings);
+    // The engine derives angular velocity and acceleration from dt itself
+    static constexpr bool estimatesState = false;
+
+    explicit MovingFlankDetector(const S &rowerSettings, uint32_t cyclesPerSec = sys_clock_hw_cycles_per_sec());
+
+    // Back to the state of a stopped flywheel, e.g. after a pause
+    void reset();
+
+    // New settings between two impulses. The ring always holds the last
+    // FLANK_ARRAY_SIZE impulses, so a new flank length is counted over
+    // real history; the filter keeps its newest values.
+    void applySettings(const S &rowerSettings);
 
-    void pushValue(double dataPoint);
+    // dt in seconds, and the same impulse in timer cycles for the flank timing
+    void pushValue(T dataPoint, uint32_t cycles);
 
     // State Checks
     bool isFlywheelPowered();
     bool isFlywheelUnpowered();
 
     // Getters
-    double timeToBeginOfFlank();
-    double noImpulsesToBeginFlank();
-    double impulseLengthAtBeginFlank();
-    double accelerationAtBeginOfFlank();
+    uint64_t cyclesToBeginOfFlank();
+    T noImpulsesToBeginFlank();
+    T impulseLengthAtBeginFlank();
+    T accelerationAtBeginOfFlank();
 };
@@ -0,0 +1,169 @@
+#pragma once
+#include "PhysicsScalar.h"
+
+/**
+ * @brief Savitzky-Golay weights for a causal window of W samples.
+ * * Least-squares fit of a polynomial of degree ORDER through the last W
+ * samples (newest at x = 0, older ones at x = -1, -2, ...), evaluated at
+ * the sample DELAY pushes old. value[age] weights the sample `age` pushes
+ * old for the fitted value, slope[age] for its first derivative (per sample).
+ * * Computed by constexpr Gaussian elimination on the normal equations, so
+ * only the finished weights end up in the firmware.
+ */
+template<int W, int ORDER, int DELAY>
+struct SavitzkyGolayWeights {
+    static_assert(ORDER >= 1 && ORDER < W, "Savitzky-Golay needs 1 <= ORDER < window length");
+    static_assert(DELAY >= 0 && DELAY < W, "Savitzky-Golay delay must lie inside the window");
+
+    double value[W] = {};
+    double slope[W] = {};
+
+    constexpr SavitzkyGolayWeights() {
+        constexpr int M = ORDER + 1;
+
+        // Normal matrix: sum over the window of x^(i + j)
+        double normal[M][M] = {};
+        for (int i = 0; i < M; i++) {
+            for (int j = 0; j < M; j++) {
+                for (int age = 0; age < W; age++) {
+                    normal[i][j] += power(-age, i + j);
+                }
+            }
+        }
+
+        // Solve normal * z = basis(x) and normal * z = basis'(x) at x = -DELAY together
+        double rhs[M][2] = {};
+        for (int i = 0; i < M; i++) {
+            rhs[i][0] = power(-DELAY, i);
+            rhs[i][1] = (i == 0) ? 0.0 : i * power(-DELAY, i - 1);
+        }
+        for (int col = 0; col < M; col++) {
+            int pivot = col;
+            for (int row = col + 1; row < M; row++) {
+                if (absolute(normal[row][col]) > absolute(normal[pivot][col])) pivot = row;
+            }
+            for (int k = 0; k < M; k++) {
+                double tmp = normal[col][k];
+                normal[col][k] = normal[pivot][k];
+                normal[pivot][k] = tmp;
+            }
+            for (int k = 0; k < 2; k++) {
+                double tmp = rhs[col][k];
+                rhs[col][k] = rhs[pivot][k];
+                rhs[pivot][k] = tmp;
+            }
+            for (int row = 0; row < M; row++) {
+                if (row == col) continue;
+                double factor = normal[row][col] / normal[col][col];
+                for (int k = 0; k < M; k++) normal[row][k] -= factor * normal[col][k];
+                for (int k = 0; k < 2; k++) rhs[row][k] -= factor * rhs[col][k];
+            }
+        }
+
+        // Weight of each sample: the fitted polynomial's value / slope at x = -DELAY
+        for (int age = 0; age < W; age++) {
+            for (int i = 0; i < M; i++) {
+                double basis = power(-age, i);
+                value[age] += (rhs[i][0] / normal[i][i]) * basis;
+                slope[age] += (rhs[i][1] / normal[i][i]) * basis;
+            }
+        }
+    }
+
+private:
+    static constexpr double power(int x, int n) {
+        double result = 1.0;
+        for (int i = 0; i < n; i++) result *= x;
+        return result;
+    }
+
+    static constexpr double absolute(double x) {
+        return x < 0.0 ? -x : x;
+    }
+};
+
+/**
+ * @brief Causal Savitzky-Golay smoother and first derivative of the dt series.
+ * * Drop-in for the moving average in MovingFlankDetector: one FIR pass over
+ * the impulse ring gives the smoothed dt and its slope per impulse, so the
+ * angular acceleration no longer comes from differencing two smoothed
+ * samples. The weights are constant expressions of type T.
+ */
+template<typename T = PhysicsScalar, int W = CONFIG_ORM_SG_WINDOW, int ORDER = CONFIG_ORM_SG_ORDER,
+         int DELAY = CONFIG_ORM_SG_DELAY>
+class SavitzkyGolayFilter {
+private:
+    struct Weights {
+        T value[W];
+        T slope[W];
+    };
+
+    static constexpr Weights makeWeights() {
+        constexpr SavitzkyGolayWeights<W, ORDER, DELAY> weights{};
+        Weights result{};
+        for (int age = 0; age < W; age++) {
+            result.value[age] = T(weights.value[age]);
+            result.slope[age] = T(weights.slope[age]);
+        }
+        return result;
+    }
+
+    static constexpr Weights weights = makeWeights();
+
+    T dataPoints[W];
+    int head; // dataPoints[head] is the last pushed value
+    T value;
+    T slope;
+
+    void apply() {
+        T sum = T(0);
+        T derivative = T(0);
+        int idx = head;
+        for (int age = 0; age < W; age++) {
+            sum += weights.value[age] * dataPoints[idx];
+            derivative += weights.slope[age] * dataPoints[idx];
+            idx = (idx == 0) ? W - 1 : idx - 1;
+        }
+        value = sum;
+        slope = derivative;
+    }
+
+public:
+    static constexpr bool hasDerivative = true;
+    static constexpr const char *name = "savitzky-golay";
+
+    template<typename S>
+    explicit SavitzkyGolayFilter(const S &settings) {
+        reset(settings.maximumTimeBetweenSteps);
+    }
+
+    // The window and the weights are fixed at compile time
+    template<typename S>
+    void applySettings(const S & /* settings */) {}
+
+    void pushValue(T dataPoint) {
+        head = (head + 1 == W) ? 0 : head + 1;
+        dataPoints[head] = dataPoint;
+        apply();
+    }
+
+    // Overwrites the value of the last pushValue() (used by the change limiter)
+    void replaceLastPushedValue(T dataPoint) {
+        dataPoints[head] = dataPoint;
+        apply();
+    }
+
+    T getValue() const { return value; }
+
+    // d(value) per impulse
+    T getSlope() const { return slope; }
+
+    void reset(T initValue) {
+        for (int i = 0; i < W; i++) {
+            dataPoints[i] = initValue;
+        }
+        head = 0;
+        value = initValue;
+        slope = T(0);
+    }
+};
@@ -0,0 +1,113 @@
+#include "RegressionFlankDetector.h"
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(RegressionFlankDetector, LOG_LEVEL_DBG);
+
+template<typename T, typename S>
+RegressionFlankDetector<T, S>::RegressionFlankDetector(const S &rowerSettings, uint32_t cyclesPerSec)
+    : settings(rowerSettings),
+      angularVelocity(flankLength() + 1, rowerSettings.maximumTimeBetweenSteps,
+                      rowerSettings.angularDisplacementPerStep / rowerSettings.maximumTimeBetweenSteps),
+      clock(cyclesPerSec),
+      defaultCycles(clock.toCycles(rowerSettings.maximumTimeBetweenSteps)) {
+
+    reset();
+}
+
+template<typename T, typename S>
+void RegressionFlankDetector<T, S>::reset() {
+    angularVelocity.reset(settings.maximumTimeBetweenSteps,
+                          settings.angularDisplacementPerStep / settings.maximumTimeBetweenSteps);
+
+    for (int i = 0; i < REGRESSION_WINDOW_SIZE; i++) {
+        dirtyCycles[i] = defaultCycles;
+    }
+    head = 0;
+    dirtyCycleSum = (uint64_t)defaultCycles * (flankLength() + 1);
+
+    previousClean = settings.maximumTimeBetweenSteps;
+}
+
+template<typename T, typename S>
+void RegressionFlankDetector<T, S>::applySettings(const S &rowerSettings) {
+    int previousLength = flankLength();
+    settings = rowerSettings;
+    defaultCycles = clock.toCycles(settings.maximumTimeBetweenSteps);
+    if (flankLength() != previousLength) {
+        angularVelocity = decltype(angularVelocity)(flankLength() + 1, settings.maximumTimeBetweenSteps,
+                                                    settings.angularDisplacementPerStep / settings.maximumTimeBetweenSteps);
+        reset();
+    }
+}
+
+template<typename T, typename S>
+void RegressionFlankDetector<T, S>::pushValue(T dataPoint, uint32_t cycles) {
+    // 1. Raw cycle window (the last flankLength + 1 impulses)
+    const int windowLength = flankLength() + 1;
+    head = (head + 1 == windowLength) ? 0 : head + 1;
+    dirtyCycleSum -= dirtyCycles[head];
+    dirtyCycleSum += cycles;
+    dirtyCycles[head] = cycles;
+
+    // 2. Noise Filter: Bounds Check. Everything else is left to the regression.
+    T clean = dataPoint;
+    if (clean < settings.minimumTimeBetweenSteps || clean > settings.maximumTimeBetweenSteps) {
+        LOG_DBG("Noise Filter: Out of bounds %f", static_cast<double>(dataPoint));
+        clean = previousClean;
+    }
+
+    // 3. Angular velocity over this impulse, half an impulse after the previous midpoint
+    T midpointDistance = (previousClean + clean) * T(0.5);
+    angularVelocity.push(midpointDistance, settings.angularDisplacementPerStep / clean);
+    previousClean = clean;
+}
+
+template<typename T, typename S>
+bool RegressionFlankDetector<T, S>::isFlywheelPowered() {
+    if (!(angularVelocity.slope() > T(0))) {
+        return false;
+    }
+    int numberOfErrors = angularVelocity.pairsAtOrBelow(T(0));
+    return (numberOfErrors <= allowedPairErrors());
+}
+
+template<typename T, typename S>
+bool RegressionFlankDetector<T, S>::isFlywheelUnpowered() {
+    T threshold = unpoweredThreshold();
+    if (!(angularVelocity.slope() < threshold)) {
+        return false;
+    }
+    int numberOfErrors = angularVelocity.pairsAtOrAbove(threshold);
+    return (numberOfErrors <= allowedPairErrors());
+}
+
+template<typename T, typename S>
+uint64_t RegressionFlankDetector<T, S>::cyclesToBeginOfFlank() {
+    return dirtyCycleSum;
+}
+
+template<typename T, typename S>
+T RegressionFlankDetector<T, S>::noImpulsesToBeginFlank() {
+    return T(flankLength());
+}
+
+template<typename T, typename S>
+T RegressionFlankDetector<T, S>::impulseLengthAtBeginFlank() {
+    T velocity = angularVelocity.fittedAt(flankLength());
+    return (velocity > T(0)) ? settings.angularDisplacementPerStep / velocity : settings.maximumTimeBetweenSteps;
+}
+
+template<typename T, typename S>
+T RegressionFlankDetector<T, S>::accelerationAtBeginOfFlank() {
+    // Constant over the window for a linear fit
+    return angularVelocity.slope();
+}
+
+// Explicit instantiations for every arithmetic type the engine can be built with,
+// with both settings types
+template class RegressionFlankDetector<double, RowingSettings<double>>;
+template class RegressionFlankDetector<float, RowingSettings<float>>;
+template class RegressionFlankDetector<Fixed, RowingSettings<Fixed>>;
+template class RegressionFlankDetector<double, StaticRowingSettings<double>>;
+template class RegressionFlankDetector<float, StaticRowingSettings<float>>;
+template class RegressionFlankDetector<Fixed, StaticRowingSettings<Fixed>>;
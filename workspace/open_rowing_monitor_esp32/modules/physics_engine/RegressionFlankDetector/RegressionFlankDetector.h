@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <zephyr/kernel.h>
+
+#include "RowingSettings.h"
+#include "TheilSenSeries.h"
+
+// Largest window the Kconfig flank length can ask for
+#define REGRESSION_WINDOW_SIZE (CONFIG_ORM_FLANK_LENGTH + 1)
+
+/**
+ * @brief Flank detector on a Theil-Sen regression of the angular velocity.
+ * * Same interface as MovingFlankDetector. Instead of smoothing dt with a
+ * moving average and counting monotonic neighbour pairs, it fits the
+ * angular velocity of the last flankLength + 1 impulses against time.
+ * The median pair slope is the angular acceleration: a noisy magnet moves
+ * it far less than it moves an average, and there is no smoothing lag.
+ * * Powered: acceleration above 0. Unpowered: below naturalDeceleration
+ * (when that is negative, as in upstream Open Rowing Monitor), else below 0.
+ * numberOfErrorsAllowed is counted in impulses: each one may spoil the
+ * flankLength pair slopes it takes part in.
+ * * S is the settings type: RowingSettings<T> (runtime values, copied in) or
+ * StaticRowingSettings<T> (Kconfig constants, folded into the loops).
+ */
+template<typename T = PhysicsScalar, typename S = DefaultRowingSettings<T>>
+class RegressionFlankDetector {
+private:
+    S settings;
+
+    // Angular velocity of each impulse, placed at the middle of the impulse
+    TheilSenSeries<REGRESSION_WINDOW_SIZE, T> angularVelocity;
+
+    // Raw impulse lengths of the window in timer cycles, for cyclesToBeginOfFlank()
+    uint32_t dirtyCycles[REGRESSION_WINDOW_SIZE];
+    int head;
+    uint64_t dirtyCycleSum;
+
+    T previousClean;
+
+    // maximumTimeBetweenSteps in timer cycles, what reset() fills the window with
+    // (clock converts it again when the settings change)
+    CycleClock<T> clock;
+    uint32_t defaultCycles;
+
+    // settings.flankLength clamped to the buffer (folds to a constant with StaticRowingSettings)
+    int flankLength() const {
+        int len = settings.flankLength;
+        if (len >= REGRESSION_WINDOW_SIZE) len = REGRESSION_WINDOW_SIZE - 1;
+        return (len < 1) ? 1 : len;
+    }
+
+    int allowedPairErrors() const {
+        return settings.numberOfErrorsAllowed * flankLength();
+    }
+
+    T unpoweredThreshold() const {
+        return (settings.naturalDeceleration < T(0)) ? settings.naturalDeceleration : T(0);
+    }
+
+public:
+    // The engine derives angular velocity and acceleration from dt itself
+    static constexpr bool estimatesState = false;
+
+    explicit RegressionFlankDetector(const S &rowerSettings, uint32_t cyclesPerSec = sys_clock_hw_cycles_per_sec());
+
+    // Back to the state of a stopped flywheel, e.g. after a pause
+    void reset();
+
+    // New settings between two impulses. The series is built for one
+    // length, so a new flank length starts it over from a stopped flywheel.
+    void applySettings(const S &rowerSettings);
+
+    // dt in seconds, and the same impulse in timer cycles for the flank timing
+    void pushValue(T dataPoint, uint32_t cycles);
+
+    // State Checks
+    bool isFlywheelPowered();
+    bool isFlywheelUnpowered();
+
+    // Getters
+    uint64_t cyclesToBeginOfFlank();
+    T noImpulsesToBeginFlank();
+    T impulseLengthAtBeginFlank();
+    T accelerationAtBeginOfFlank();
+};
@@ -0,0 +1,166 @@
+#pragma once
+#include "PhysicsScalar.h"
+
+/**
+ * @brief Theil-Sen linear regression over the last `length` (x, y) points, length <= N.
+ * * The slope is the median of the slopes between every pair of points, so a
+ * single bad point moves it far less than it moves a least-squares fit.
+ * * The pair slopes are cached per ring slot: a push computes the length - 1
+ * slopes of the new point and selects the median of the
+ * length * (length - 1) / 2 cached ones, O(N^2) per push for a compile-time N.
+ * * x is passed as an increment. The stored x values are rebased once per lap
+ * so they stay as small as the window, whatever the session length.
+ */
+template<int N, typename T = PhysicsScalar>
+class TheilSenSeries {
+    static_assert(N >= 2, "TheilSenSeries needs a capacity of at least 2");
+
+private:
+    static constexpr int MAX_PAIRS = N * (N - 1) / 2;
+
+    T x[N];
+    T y[N];
+    T pairSlope[N][N]; // pairSlope[a][b] == pairSlope[b][a], slope between slots a and b
+    T scratch[MAX_PAIRS > N ? MAX_PAIRS : N];
+    int length;
+    int head; // x[head], y[head] is the last pushed point
+    T medianSlope;
+
+    int slotAt(int age) const {
+        int idx = head - age;
+        return (idx < 0) ? idx + length : idx;
+    }
+
+    // Median of scratch[0..n) (reorders scratch). Quickselect, O(n) on average.
+    T median(int n) {
+        int k = n / 2;
+        T upper = select(n, k);
+        if (n % 2 != 0) return upper;
+        // scratch[0..k) now holds the smaller half, its maximum is the lower median
+        T lower = scratch[0];
+        for (int i = 1; i < k; i++) {
+            if (scratch[i] > lower) lower = scratch[i];
+        }
+        return (lower + upper) * T(0.5);
+    }
+
+    T select(int n, int k) {
+        int lo = 0;
+        int hi = n - 1;
+        while (lo < hi) {
+            T pivot = scratch[(lo + hi) / 2];
+            int i = lo;
+            int j = hi;
+            while (i <= j) {
+                while (scratch[i] < pivot) i++;
+                while (pivot < scratch[j]) j--;
+                if (i <= j) {
+                    T tmp = scratch[i];
+                    scratch[i] = scratch[j];
+                    scratch[j] = tmp;
+                    i++;
+                    j--;
+                }
+            }
+            if (k <= j) {
+                hi = j;
+            } else if (k >= i) {
+                lo = i;
+            } else {
+                break;
+            }
+        }
+        return scratch[k];
+    }
+
+public:
+    // requestedLength is clamped to 2..N
+    TheilSenSeries(int requestedLength, T dx, T initValue)
+        : length(requestedLength < 2 ? 2 : (requestedLength > N ? N : requestedLength)) {
+        reset(dx, initValue);
+    }
+
+    // Fills the window with a flat line of points dx apart
+    void reset(T dx, T initValue) {
+        for (int i = 0; i < length; i++) {
+            x[i] = dx * T(i - (length - 1));
+            y[i] = initValue;
+            for (int j = 0; j < length; j++) {
+                pairSlope[i][j] = T(0);
+            }
+        }
+        head = length - 1;
+        medianSlope = T(0);
+    }
+
+    // Adds a point dx after the last one (dx > 0), replacing the oldest
+    void push(T dx, T value) {
+        T newX = x[head] + dx;
+        head = (head + 1 == length) ? 0 : head + 1;
+        x[head] = newX;
+        y[head] = value;
+
+        if (head == 0) {
+            // Rebase once per lap so float x keeps its resolution
+            T origin = x[0];
+            for (int i = 0; i < length; i++) {
+                x[i] -= origin;
+            }
+        }
+
+        for (int i = 0; i < length; i++) {
+            if (i == head) continue;
+            T s = (y[head] - y[i]) / (x[head] - x[i]);
+            pairSlope[head][i] = s;
+            pairSlope[i][head] = s;
+        }
+
+        int n = 0;
+        for (int a = 0; a < length; a++) {
+            for (int b = a + 1; b < length; b++) {
+                scratch[n++] = pairSlope[a][b];
+            }
+        }
+        medianSlope = median(n);
+    }
+
+    int size() const { return length; }
+    int pairCount() const { return length * (length - 1) / 2; }
+
+    T slope() const { return medianSlope; }
+
+    // Point `age` pushes ago (0 = newest)
+    T xAt(int age) const { return x[slotAt(age)]; }
+    T yAt(int age) const { return y[slotAt(age)]; }
+
+    // Fitted y at the x of the point `age` pushes ago: median of the
+    // per-point intercepts, evaluated there
+    T fittedAt(int age) {
+        T at = x[slotAt(age)];
+        for (int i = 0; i < length; i++) {
+            scratch[i] = y[i] + medianSlope * (at - x[i]);
+        }
+        return median(length);
+    }
+
+    // Number of pair slopes <= threshold / >= threshold
+    int pairsAtOrBelow(T threshold) const {
+        int count = 0;
+        for (int a = 0; a < length; a++) {
+            for (int b = a + 1; b < length; b++) {
+                if (pairSlope[a][b] <= threshold) count++;
+            }
+        }
+        return count;
+    }
+
+    int pairsAtOrAbove(T threshold) const {
+        int count = 0;
+        for (int a = 0; a < length; a++) {
+            for (int b = a + 1; b < length; b++) {
+                if (pairSlope[a][b] >= threshold) count++;
+            }
+        }
+        return count;
+    }
+};
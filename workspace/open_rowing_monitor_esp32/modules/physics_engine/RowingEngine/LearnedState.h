@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief What the engine learns while rowing and can start the next session with.
+ * * Today that is the drag factor of CONFIG_ORM_AUTO_ADJUST_DRAG_FACTOR. It
+ * is only valid for the flywheel it was learned on, so it carries a
+ * fingerprint of the rower model and the calibration (inertia, impulses
+ * per revolution, configured drag factor). A state with another
+ * fingerprint is not restored: the rower was recalibrated.
+ * * Plain data of fixed size, whatever the arithmetic type of the engine:
+ * it is stored as is (see WarmStart).
+ */
+struct LearnedState {
+    uint32_t format;        // LEARNED_STATE_FORMAT, bumped when the layout changes
+    uint32_t fingerprint;   // learnedStateFingerprint() it was learned with
+    double dragFactor;      // In the unit of the rower model
+};
+
+#define LEARNED_STATE_FORMAT 1
+
+// FNV-1a over the model name and the calibration, in Kconfig units
+inline uint32_t learnedStateFingerprint(const char *model, double flywheelInertia, double impulsesPerRevolution,
+                                        double dragFactorSetting) {
+    uint32_t hash = 2166136261u;
+    auto add = [&hash](uint32_t byte) {
+        hash = (hash ^ (byte & 0xff)) * 16777619u;
+    };
+    for (const char *c = model; *c != '\0'; c++) {
+        add((uint8_t)*c);
+    }
+    const int32_t values[] = {
+        (int32_t)std::lround(flywheelInertia * 10000.0),
+        (int32_t)std::lround(impulsesPerRevolution),
+        (int32_t)std::lround(dragFactorSetting * 1000000.0),
+    };
+    for (int32_t value : values) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            add((uint32_t)value >> shift);
+        }
+    }
+    return hash;
+}
+
+// True when now is worth a flash write over saved: another rower or
+// calibration, or a drag factor that moved by more than minChange (relative)
+inline bool learnedStateChanged(const LearnedState &saved, const LearnedState &now, double minChange) {
+    if (saved.format != now.format || saved.fingerprint != now.fingerprint) return true;
+    if (saved.dragFactor <= 0.0) return now.dragFactor > 0.0;
+    return std::fabs(now.dragFactor - saved.dragFactor) > minChange * saved.dragFactor;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "PhysicsScalar.h"
+
+/**
+ * @brief Resistance, drag estimation and distance models of the rower.
+ *
+ * RowingEngine is instantiated with one model, so the per-impulse math is
+ * plain inline arithmetic for that machine: no virtual calls and no
+ * branches on the rower type. A model bundles:
+ *  - Resistance: drag torque at flywheel speed w, and the drag estimator,
+ *    the same law solved for the drag factor from a coasting deceleration
+ *    (I * -alpha = torque(drag, w)).
+ *  - Distance: boat speed from the flywheel angle turned over a stroke.
+ *
+ * The drag factor's unit follows the resistance law (N*m*s^2 quadratic,
+ * N*m*s linear), so CONFIG_ORM_DRAG_FACTOR has to be set per model.
+ */
+
+// Fan or paddle: drag torque grows with the square of the speed
+template<typename T>
+struct QuadraticResistance {
+    static T torque(T drag, T w) { return drag * w * w; }
+    static T dragFromDeceleration(T inertia, T alpha, T w) { return (inertia * -alpha) / (w * w); }
+    // A drag factor above this is physically impossible for a rower (usually 0.0001 - 0.005)
+    static T maximumDrag() { return T(0.1); }
+};
+
+// Eddy-current brake: drag torque grows linearly with the speed
+template<typename T>
+struct LinearResistance {
+    static T torque(T drag, T w) { return drag * w; }
+    static T dragFromDeceleration(T inertia, T alpha, T w) { return (inertia * -alpha) / w; }
+    static T maximumDrag() { return T(1); }
+};
+
+// Concept2 style: the boat goes as fast as the same power would move it,
+// P = magicConstant * v^3, with P the drag power at the average speed
+template<typename T, typename R>
+struct EquivalentPowerDistance {
+    template<typename S>
+    static T linearVelocity(const S &settings, T drag, T angle, T time) {
+        T w = angle / time;
+        return scalarCbrt(R::torque(drag, w) * w / settings.magicConstant);
+    }
+};
+
+// Quadratic case of the above, with the cube root taken of the drag alone
+// (no w^3 to overflow the fixed-point range)
+template<typename T>
+struct EquivalentPowerDistance<T, QuadraticResistance<T>> {
+    template<typename S>
+    static T linearVelocity(const S &settings, T drag, T angle, T time) {
+        return scalarCbrt(drag / settings.magicConstant) * (angle / time);
+    }
+};
+
+// Water: the tank's drag does not change within a session, so distance is
+// a fixed gearing of the flywheel angle, set by the configured drag factor
+// instead of the learned one
+template<typename T>
+struct GearedDistance {
+    template<typename S>
+    static T linearVelocity(const S &settings, T /* drag */, T angle, T time) {
+        return scalarCbrt(settings.dragFactor / settings.magicConstant) * (angle / time);
+    }
+};
+
+template<typename T = PhysicsScalar>
+struct AirRowerModel {
+    static constexpr const char *name = "air";
+    using Resistance = QuadraticResistance<T>;
+    using Distance = EquivalentPowerDistance<T, Resistance>;
+};
+
+template<typename T = PhysicsScalar>
+struct MagneticRowerModel {
+    static constexpr const char *name = "magnetic";
+    using Resistance = LinearResistance<T>;
+    using Distance = EquivalentPowerDistance<T, Resistance>;
+};
+
+template<typename T = PhysicsScalar>
+struct WaterRowerModel {
+    static constexpr const char *name = "water";
+    using Resistance = QuadraticResistance<T>;
+    using Distance = GearedDistance<T>;
+};
+
+// Rower model, selected in Kconfig
+#if defined(CONFIG_ORM_ROWER_MODEL_MAGNETIC)
+    template<typename T = PhysicsScalar> using DefaultRowerModel = MagneticRowerModel<T>;
+#elif defined(CONFIG_ORM_ROWER_MODEL_WATER)
+    template<typename T = PhysicsScalar> using DefaultRowerModel = WaterRowerModel<T>;
+#else
+    template<typename T = PhysicsScalar> using DefaultRowerModel = AirRowerModel<T>;
+#endif
@@ -3,299 +3,922 @@
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(RowingEngine, LOG_LEVEL_INF);
-static RowingState lastLoggedState = RowingState::RECOVERY;
 
-RowingEngine::RowingEngine(RowingSettings &rs)
-    : settings(rs),
-      flankDetector(rs),
-      dragFactorAverager(rs.dampingConstantSmoothing, rs.dragFactor) {
+K_THREAD_STACK_DEFINE(strokeWorkQueueStack, CONFIG_ORM_STROKE_WORKQ_STACK_SIZE);
+static k_work_q strokeWorkQueue;
+static bool strokeWorkQueueStarted = false;
+
+k_work_q *rowingStrokeWorkQueue() {
+    // First call happens from main() while the engines are built
+    if (!strokeWorkQueueStarted) {
+        struct k_work_queue_config config = {};
+        config.name = "orm_stroke_wq";
+        k_work_queue_init(&strokeWorkQueue);
+        k_work_queue_start(&strokeWorkQueue, strokeWorkQueueStack,
+                           K_THREAD_STACK_SIZEOF(strokeWorkQueueStack),
+                           CONFIG_ORM_STROKE_WORKQ_PRIORITY, &config);
+        strokeWorkQueueStarted = true;
+    }
+    return &strokeWorkQueue;
+}
 
-    k_mutex_init(&dataLock);
-    angularDisplacementPerImpulse = (2.0 * 3.14159265359) / settings.numOfImpulsesPerRevolution;
+template<typename T, typename S, typename M>
+RowingEngine<T, S, M>::RowingEngine(const S &rs, uint32_t cyclesPerSec)
+    : settings(rs),
+      flankDetector(rs, cyclesPerSec),
+      dragFactorMedian(rs.dampingConstantSmoothing, rs.dragFactor),
+      clock(cyclesPerSec),
+      minimumImpulseCycles(clock.toCycles(rs.minimumTimeBetweenImpulses)),
+      maximumImpulseCycles(clock.toCycles(rs.maximumImpulseTimeBeforePause)),
+      minimumDriveCycles(clock.toCycles(rs.minimumDriveTime)),
+      minimumRecoveryCycles(clock.toCycles(rs.minimumRecoveryTime)),
+      dragFactor(rs.dragFactor) {
+
+    k_mutex_init(&writeLock);
+    k_mutex_init(&strokeLock);
+    strokeWork.engine = this;
+    k_work_init(&strokeWork.work, strokeWorkHandler);
+#ifdef CONFIG_ORM_DEFERRED_STROKE_PROCESSING
+    strokeQueue = rowingStrokeWorkQueue();
+#endif
     reset();
     printSettings();
     LOG_INF("RowingEngine Initialized");
 }
 
-RowingData RowingEngine::getData() {
-    k_mutex_lock(&dataLock, K_FOREVER);
-    RowingData copy = currentData;
-    k_mutex_unlock(&dataLock);
-    return copy;
+template<typename T, typename S, typename M>
+RowingData<T> RowingEngine<T, S, M>::getData() const {
+    // Stroke-level fields from stage 2, everything that changes per impulse from stage 1
+    RowingData<T> data = publishedStroke.read();
+    RowingData<T> impulse = publishedData.read();
+    data.state = impulse.state;
+    data.totalTime = impulse.totalTime;
+    data.driveDuration = impulse.driveDuration;
+    data.recoveryDuration = impulse.recoveryDuration;
+    data.dragFactor = impulse.dragFactor;
+    data.instTorque = impulse.instTorque;
+    data.impulsePower = impulse.impulsePower;
+    data.angularAcceleration = impulse.angularAcceleration;
+    data.strokeCount = impulse.strokeCount;
+    return data;
+}
+
+template<typename T, typename S, typename M>
+uint32_t RowingEngine<T, S, M>::getReaderRetries() const {
+    return publishedData.readerRetries() + publishedStroke.readerRetries();
 }
 
-void RowingEngine::reset() {
-    k_mutex_lock(&dataLock, K_FOREVER);
-    currentData = RowingData();
-    currentData.dragFactor = settings.dragFactor;
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::followSettings(const SettingsStore<S> &store) {
+    if constexpr (S::tunable) {
+        settingsStore = &store;
+        refreshSettings();
+    }
+}
+
+// Physics thread, between two impulses. Only the copy-out of the snapshot
+// touches the store; the engine's own locks keep stage 2 and session
+// control off the settings while they change.
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::refreshSettings() {
+    if constexpr (S::tunable) {
+        S next;
+        uint32_t version;
+        if (!settingsStore->tryRead(next, version)) {
+            return; // A writer is publishing, take it at the next impulse
+        }
+
+        k_mutex_lock(&writeLock, K_FOREVER);
+        k_mutex_lock(&strokeLock, K_FOREVER);
+        // A new drag factor or median length restarts the learned drag from the setting
+        bool restartDrag = (next.dragFactor != settings.dragFactor) ||
+                           (next.dampingConstantSmoothing != settings.dampingConstantSmoothing);
+        settings = next;
+        settingsVersion = version;
+
+        flankDetector.applySettings(settings);
+        minimumImpulseCycles = clock.toCycles(settings.minimumTimeBetweenImpulses);
+        maximumImpulseCycles = clock.toCycles(settings.maximumImpulseTimeBeforePause);
+        minimumDriveCycles = clock.toCycles(settings.minimumDriveTime);
+        minimumRecoveryCycles = clock.toCycles(settings.minimumRecoveryTime);
+
+        if (restartDrag || !settings.autoAdjustDragFactor) {
+            dragFactor = settings.dragFactor;
+        }
+        if (restartDrag) {
+            dragFactorMedian = MovingMedian<DRAG_MEDIAN_SIZE, T>(settings.dampingConstantSmoothing, dragFactor);
+        }
+        currentData.dragFactor = dragFactor;
+        publishedData.publish(currentData); // getLearnedState() pairs it with the new settings
+        k_mutex_unlock(&strokeLock);
+        k_mutex_unlock(&writeLock);
+        LOG_INF("Settings version %u applied", version);
+    }
+}
+
+template<typename T, typename S, typename M>
+uint32_t RowingEngine<T, S, M>::learnedFingerprint() const {
+    return learnedStateFingerprint(M::name, static_cast<double>(settings.flywheelInertia),
+                                   static_cast<double>(settings.numOfImpulsesPerRevolution),
+                                   static_cast<double>(settings.dragFactor));
+}
+
+// Any thread. strokeLock keeps the settings still, the drag factor comes
+// from the published snapshot, so the physics thread is never waited on.
+template<typename T, typename S, typename M>
+LearnedState RowingEngine<T, S, M>::getLearnedState() const {
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    LearnedState state{LEARNED_STATE_FORMAT, learnedFingerprint(),
+                       static_cast<double>(publishedData.read().dragFactor)};
+    k_mutex_unlock(&strokeLock);
+    return state;
+}
+
+template<typename T, typename S, typename M>
+bool RowingEngine<T, S, M>::restoreLearnedState(const LearnedState &state) {
+    k_mutex_lock(&writeLock, K_FOREVER);
+    bool valid = settings.autoAdjustDragFactor && state.format == LEARNED_STATE_FORMAT &&
+                 state.fingerprint == learnedFingerprint() &&
+                 state.dragFactor > 0.0 && state.dragFactor < static_cast<double>(M::Resistance::maximumDrag());
+    if (valid) {
+        dragFactor = T(state.dragFactor);
+    }
+    k_mutex_unlock(&writeLock);
+    if (!valid) {
+        return false;
+    }
+
+    // reset() seeds the published data and the drag median from it
+    reset();
+    LOG_INF("Warm start: drag factor %f", static_cast<double>(dragFactor));
+    return true;
+}
+
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::setStrokeWorkQueue(k_work_q *queue) {
+    flushStrokes();
+    k_mutex_lock(&writeLock, K_FOREVER);
+    strokeQueue = queue;
+    k_mutex_unlock(&writeLock);
+}
+
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::flushStrokes() {
+    if (strokeQueue != nullptr) {
+        struct k_work_sync sync;
+        k_work_flush(&strokeWork.work, &sync);
+    }
+}
+
+template<typename T, typename S, typename M>
+StrokeStageStats RowingEngine<T, S, M>::getStrokeStageStats() const {
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    StrokeStageStats stats = strokeStats;
+    k_mutex_unlock(&strokeLock);
+    stats.dropped = (uint32_t)atomic_get(&droppedStrokes);
+    return stats;
+}
+
+template<typename T, typename S, typename M>
+int RowingEngine<T, S, M>::getStrokeHistory(StrokeSample<T> *out, int max) const {
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    int count = strokeHistory.size();
+    if (count > max) count = max;
+    for (int i = 0; i < count; i++) {
+        out[i] = strokeHistory.at(i);
+    }
+    k_mutex_unlock(&strokeLock);
+    return count;
+}
+
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::startWorkout(const WorkoutProgram &program) {
+    // Strokes still queued belong to the rowing before the workout
+    flushStrokes();
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    workout.start(program);
+    k_mutex_unlock(&strokeLock);
+}
+
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::stopWorkout() {
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    workout.stop();
+    k_mutex_unlock(&strokeLock);
+}
+
+template<typename T, typename S, typename M>
+WorkoutStatus<T> RowingEngine<T, S, M>::getWorkoutStatus() const {
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    WorkoutStatus<T> status = workout.getStatus(k_uptime_get_32());
+    k_mutex_unlock(&strokeLock);
+    return status;
+}
+
+template<typename T, typename S, typename M>
+bool RowingEngine<T, S, M>::getIntervalSplit(int i, IntervalSplit<T> &split) const {
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    bool valid = (i >= 0 && i < workout.intervalCount());
+    if (valid) split = workout.getSplit(i);
+    k_mutex_unlock(&strokeLock);
+    return valid;
+}
+
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::reset() {
+    k_mutex_lock(&writeLock, K_FOREVER);
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    currentData = RowingData<T>();
+    currentData.dragFactor = dragFactor;
     currentData.state = RowingState::RECOVERY;
-    k_mutex_unlock(&dataLock);
+    strokeData = RowingData<T>();
+    strokeHistory.reset();
+    strokeSeconds = T(0);
+
+    // Drop stroke records that were not processed yet
+    atomic_set(&strokeTail, atomic_get(&strokeHead));
+
+    dragFactorMedian.reset(dragFactor);
 
-    dragFactorAverager.reset(settings.dragFactor);
+    resetPhaseState();
+    resetStrokeQuality();
 
-    double plausibleDisplacement = 8.0 / std::pow(settings.dragFactor / settings.magicConstant, 1.0/3.0);
-    recoveryPhaseStartTime = -2.0 * settings.minimumRecoveryTime;
-    recoveryPhaseStartAngularDisplacement = -1.0 * (2.0/3.0) * plausibleDisplacement / angularDisplacementPerImpulse;
-    previousAngularVelocity = 0;
+    publishedStroke.publish(strokeData);
+    publishedData.publish(currentData);
+    k_mutex_unlock(&strokeLock);
+    k_mutex_unlock(&writeLock);
 }
 
-void RowingEngine::handleRotationImpulse(double dt) {
-    /* Hmm */
-    // LOG_INF("Time between impulses %f", dt);
-    // k_mutex_lock(&dataLock, K_FOREVER);
-    // currentData.spm = 25.1;
-    // currentData.strokeCount = 300;
-    // currentData.avgSpm = 25.0;
-    // currentData.distance = 2000.2;
-    // currentData.instSpeed = 4.2;
-    // currentData.avgSpeed = 3.9;
-    // currentData.instPower = 101.4;
-    // currentData.avgPower = 100.1;
-    // currentData.sessionActive = true;
-    // currentData.sessionStartTime = 0;
-    // k_mutex_unlock(&dataLock);
-    /* Hmm */
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::resetPhaseState() {
+    totalCycles = 0;
+    totalSeconds = 0;
+    subSecondCycles = 0;
+    totalImpulses = 0;
+    restartPhases();
+}
+
+// Phase bookkeeping as if a recovery were running since now. Totals are kept.
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::restartPhases() {
+    drivePhaseStartCycles = totalCycles;
+    // Pre-seed phase timing so first stroke produces valid cycleTime
+    recoveryPhaseStartCycles = totalCycles - 2 * (int64_t)minimumRecoveryCycles;
+
+    drivePhaseStartImpulse = totalImpulses;
+    recoveryPhaseStartImpulse = totalImpulses - (int64_t)static_cast<double>(
+        T(2.0/3.0) * settings.plausibleDisplacement / settings.angularDisplacementPerImpulse);
+    for (int i = 0; i < FLANK_WINDOW_SIZE; i++) {
+        stepWork[i] = T(0);
+    }
+    phaseWork = T(0);
+    for (int i = 0; i < FLANK_WINDOW_SIZE; i++) {
+        stepTorque[i] = T(0);
+    }
+    driveCurve = DriveCurve{};
+    previousAngularVelocity = T(0);
+    waitingForDrive = false;
+    rebuiltInWindow = 0;
+    stepCycles = 0;
+    stepImpulses = 0;
+    stepRebuilt = false;
+}
+
+// Called with writeLock held
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::resetStrokeQuality() {
+    quality = StrokeQualityData<T>();
+    strokePowerStats.reset();
+    driveLengthStats.reset();
+    publishedQuality.publish(quality);
+}
 
-    /* Get dt */
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::handleRotationImpulse(uint32_t deltaCycles) {
+#ifdef CONFIG_ORM_CAPTURE_DT
     impulseCount++;
 
-    // Stop after 500 impulses (about 10 strokes worth)
+    // Stop after 2000 impulses (about 40 strokes worth)
     if (impulseCount >= 2001) {
         printk("CAPTURE_COMPLETE");
         return;
     }
-    printk("DT,%.6f\n", dt);
-    /* Get dt */
-
-    /* Main code */
-    // if (dt < settings.minimumTimeBetweenImpulses) {
-    //     return;
-    // }
-    // if (dt > settings.maximumImpulseTimeBeforePause) {
-    //     return;
-    // }
-
-    // k_mutex_lock(&dataLock, K_FOREVER);
-    // currentData.totalTime += dt;
-    // RowingState currentState = currentData.state;
-    // k_mutex_unlock(&dataLock);
-
-    // flankDetector.pushValue(dt);
-
-    // if (currentState == RowingState::DRIVE) {
-    //     if (flankDetector.isFlywheelUnpowered()) {
-    //         double driveLen = (currentData.totalTime - flankDetector.timeToBeginOfFlank()) - drivePhaseStartTime;
-    //         if (driveLen >= settings.minimumDriveTime) {
-    //             startRecoveryPhase(dt);
-    //         } else {
-    //             updateDrivePhase(dt);
-    //         }
-    //     } else {
-    //         updateDrivePhase(dt);
-    //     }
-    // } else {
-    //     if (flankDetector.isFlywheelPowered()) {
-    //         double recLen = (currentData.totalTime - flankDetector.timeToBeginOfFlank()) - recoveryPhaseStartTime;
-    //         if (recLen >= settings.minimumRecoveryTime) {
-    //             startDrivePhase(dt);
-    //         } else {
-    //             updateRecoveryPhase(dt);
-    //         }
-    //     } else {
-    //         updateRecoveryPhase(dt);
-    //     }
-    // }
-    /* Main code */
-}
-
-void RowingEngine::startDrivePhase(double dt) {
-    double endTime = currentData.totalTime - flankDetector.timeToBeginOfFlank();
-    double recoveryLen = endTime - recoveryPhaseStartTime;
-    double driveLen = currentData.driveDuration;
+    printk("DT,%.6f\n", static_cast<double>(clock.toSeconds(deltaCycles)));
+#else
+    if constexpr (S::tunable) {
+        // One atomic load per impulse while nothing changes
+        if (settingsStore != nullptr && settingsStore->getVersion() != settingsVersion) {
+            refreshSettings();
+        }
+    }
+    if (deltaCycles < minimumImpulseCycles) {
+        return;
+    }
+    if (deltaCycles > maximumImpulseCycles) {
+        return;
+    }
+    T dt = clock.toSeconds(deltaCycles);
+    lastImpulseCycles = deltaCycles;
+
+    k_mutex_lock(&writeLock, K_FOREVER);
+    if (currentData.state == RowingState::PAUSED) {
+        // The impulse that spans the pause was dropped above, so the pause is
+        // not moving time. This is the first one of the flywheel moving again.
+        resumeFromPause();
+    }
+    // Exact in cycles; totalTime is rebuilt from whole seconds so it never drifts
+    totalCycles += deltaCycles;
+    subSecondCycles += deltaCycles;
+    while (subSecondCycles >= clock.cyclesPerSecond()) {
+        subSecondCycles -= clock.cyclesPerSecond();
+        totalSeconds++;
+    }
+    currentData.totalTime = T(totalSeconds) + clock.toSeconds(subSecondCycles);
 
-    if (settings.autoAdjustDragFactor && recoveryDragSampleCount > 0) {
-        // 1. Average the samples collected during the last recovery
-        double avgDragForLastRecovery = recoveryDragAccumulator / recoveryDragSampleCount;
+    // The rest of stage 1 runs once per analysis step
+    stepCycles += deltaCycles;
+    stepRebuilt = stepRebuilt || rebuilding;
+    if (++stepImpulses < settings.impulsesPerStep) {
+        k_mutex_unlock(&writeLock);
+        return;
+    }
+    T stepDt = (stepImpulses == 1) ? dt : clock.toSeconds(stepCycles);
+    uint32_t stepDeltaCycles = stepCycles;
+    bool rebuiltStep = stepRebuilt;
+    stepCycles = 0;
+    stepImpulses = 0;
+    stepRebuilt = false;
+    RowingState currentState = currentData.state;
+
+    // Rebuilt shares only carry the mean pace of their gap: no drag sample
+    // while the flank window holds one
+    if (rebuiltStep) {
+        rebuiltInWindow = flankSteps();
+    } else if (rebuiltInWindow > 0) {
+        rebuiltInWindow--;
+    }
 
-        // 2. Smooth it using the MovingAverager (prevents jitter)
-        dragFactorAverager.pushValue(avgDragForLastRecovery);
+    flankDetector.pushValue(stepDt, stepDeltaCycles);
 
-        // 3. Update the Settings so the power calc uses the new value
-        double smoothedDrag = dragFactorAverager.getAverage();
-        settings.dragFactor = smoothedDrag;
+    T currentVel;
+    T alpha;
+    estimateFlywheelState(stepDt, currentVel, alpha);
+    integrateStep(currentVel, alpha);
 
-        // 4. Update the Data struct so the UI sees the new value
-        // (We do this inside the lock below)
+    if (currentState == RowingState::DRIVE) {
+        if (flankDetector.isFlywheelUnpowered()) {
+            int64_t driveLen = flankBeginCycles() - drivePhaseStartCycles;
+            if (driveLen >= minimumDriveCycles) {
+                startRecoveryPhase();
+            }
+        }
+    } else {
+        if (flankDetector.isFlywheelPowered()) {
+            int64_t recLen = flankBeginCycles() - recoveryPhaseStartCycles;
+            if (waitingForDrive) {
+                startFirstDrive();
+            } else if (recLen >= minimumRecoveryCycles) {
+                startDrivePhase();
+            } else {
+                updateRecoveryPhase(currentVel, alpha);
+            }
+        } else {
+            updateRecoveryPhase(currentVel, alpha);
+        }
     }
 
-    k_mutex_lock(&dataLock, K_FOREVER);
-    currentData.dragFactor = settings.dragFactor;
-    if (recoveryLen >= settings.minimumRecoveryTime && driveLen >= settings.minimumDriveTime) {
-        double cycleTime = driveLen + recoveryLen;
-        currentData.lastStrokeTime = cycleTime;
-        currentData.spm = 60.0 / cycleTime;
+    // One publication per step, readers never see a half-updated stroke
+    publishedData.publish(currentData);
+    k_mutex_unlock(&writeLock);
+#endif
+}
+
+// Bounces never reach a gap (ImpulseLossCounter gates them), so it holds
+// missedImpulses + 1 magnets, fewer only if a share would fall below the
+// gate and be dropped with its time. The flywheel is taken to change pace
+// evenly through the gap: the shares start at the last accepted impulse
+// and grow by the same step, the last one takes the rounding. Without a
+// pace, or when the ramp leaves the gate, the shares are equal. Either way
+// no cycle is lost.
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::handleRotationImpulse(uint32_t deltaCycles, uint32_t missedImpulses) {
+    if (missedImpulses == 0) {
+        handleRotationImpulse(deltaCycles);
+        return;
+    }
+    atomic_add(&missedImpulseCount, (atomic_val_t)missedImpulses);
+    uint32_t impulses = missedImpulses + 1;
+    if (minimumImpulseCycles > 0 && deltaCycles / impulses < minimumImpulseCycles) {
+        impulses = deltaCycles / minimumImpulseCycles;
+        impulses = (impulses < 1) ? 1 : impulses;
+    }
+
+    auto inGate = [this](int64_t cycles) {
+        return cycles >= (int64_t)minimumImpulseCycles && cycles <= (int64_t)maximumImpulseCycles;
+    };
+    int64_t n = impulses;
+    int64_t first = lastImpulseCycles;
+    int64_t step = (n > 1) ? 2 * ((int64_t)deltaCycles - n * first) / (n * (n - 1)) : 0;
+    int64_t lastShare = (int64_t)deltaCycles - (n - 1) * first - step * (n - 1) * (n - 2) / 2;
+    bool ramp = n > 1 && first > 0 && inGate(first) && inGate(first + step * (n - 2)) && inGate(lastShare);
+
+    rebuilding = true;
+    if (ramp) {
+        for (int64_t i = 0; i < n - 1; i++) {
+            handleRotationImpulse((uint32_t)(first + step * i));
+        }
+        handleRotationImpulse((uint32_t)lastShare);
+    } else {
+        uint32_t share = deltaCycles / impulses;
+        uint32_t remainder = deltaCycles - share * impulses;
+        for (uint32_t i = 0; i < impulses; i++) {
+            handleRotationImpulse(share + ((i < remainder) ? 1 : 0));
+        }
+    }
+    rebuilding = false;
+}
+
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::handleImpulseTimeout() {
+    // Let stage 2 finish the last stroke, so it cannot bring the numbers back
+    flushStrokes();
+
+    k_mutex_lock(&writeLock, K_FOREVER);
+    if (currentData.state == RowingState::PAUSED) {
+        k_mutex_unlock(&writeLock);
+        return;
+    }
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    LOG_INF("No impulse for %.1f s, pausing.", static_cast<double>(settings.maximumImpulseTimeBeforePause));
+
+    // The angle turned since the last record is still distance: a drive the
+    // pause cuts (already counted at its start) with the recovery before
+    // it, or the recovery after the last drive. Stage 2 is flushed and
+    // locked, so it is credited here, before the numbers are zeroed.
+    StrokeRecord rest{RowingState::PAUSED, T(0), T(0), T(0), T(0), T(0), T(0), dragFactor};
+    if (currentData.state == RowingState::DRIVE) {
+        rest.driveDuration = clock.toSeconds((uint64_t)(totalCycles - drivePhaseStartCycles));
+        rest.recoveryDuration = currentData.recoveryDuration;
+        rest.driveAngle = T((int32_t)(totalImpulses - drivePhaseStartImpulse)) * settings.angularDisplacementPerImpulse;
+        rest.recoveryAngle = T((int32_t)(drivePhaseStartImpulse - recoveryPhaseStartImpulse)) * settings.angularDisplacementPerImpulse;
+        rest.driveWork = phaseWork;
+    } else if (!waitingForDrive && currentData.strokeCount > 0) {
+        rest.recoveryDuration = clock.toSeconds((uint64_t)(totalCycles - recoveryPhaseStartCycles));
+        rest.recoveryAngle = T((int32_t)(totalImpulses - recoveryPhaseStartImpulse)) * settings.angularDisplacementPerImpulse;
+    }
+    if (rest.driveAngle + rest.recoveryAngle > T(0)) {
+        processStroke(rest);
     }
+
+    // The phase that was running ends here, totals are kept
+    currentData.state = RowingState::PAUSED;
+    currentData.instTorque = T(0);
+    currentData.impulsePower = T(0);
+    currentData.angularAcceleration = T(0);
+    strokeData.spm = T(0);
+    strokeData.instSpeed = T(0);
+    strokeData.instPower = T(0);
+    strokeData.drivePower = T(0);
+    strokeData.energyPerHour = T(0);
+
+    publishedStroke.publish(strokeData);
+    publishedData.publish(currentData);
+    k_mutex_unlock(&strokeLock);
+    k_mutex_unlock(&writeLock);
+}
+
+// Called with writeLock held. The flywheel starts from rest again: fresh
+// flank window and phases, the session totals and learned drag are kept.
+// Unlike a session start there is no pre-seeded recovery: the first stroke
+// after a pause is the one that ends a whole recovery seen since then.
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::resumeFromPause() {
+    flankDetector.reset();
+    restartPhases();
+    recoveryPhaseStartCycles = totalCycles;
+    recoveryPhaseStartImpulse = totalImpulses;
+    waitingForDrive = true;
+    recoveryDragAccumulator = T(0);
+    recoveryDragSampleCount = 0;
+    currentData.recoveryDuration = T(0);
+    currentData.state = RowingState::RECOVERY;
+}
+
+// First drive after a pause: opens the drive at the start of its flank
+// without a stroke, a drag update or a record. What came before it since
+// the resume is no recovery of a stroke.
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::startFirstDrive() {
+    int64_t endCycles = flankBeginCycles();
+    int64_t endImpulse = flankBeginImpulse();
+    endPhaseWork();
+    waitingForDrive = false;
     currentData.state = RowingState::DRIVE;
-    currentData.strokeCount++;
-    RowingData snapshot = currentData;
-    k_mutex_unlock(&dataLock);
+    currentData.recoveryDuration = T(0);
+    driveCurve = DriveCurve{};
 
-    drivePhaseStartTime = endTime;
+    drivePhaseStartCycles = endCycles;
+    drivePhaseStartImpulse = endImpulse;
+    recoveryPhaseStartCycles = endCycles;
+    recoveryPhaseStartImpulse = endImpulse;
 }
 
-void RowingEngine::updateDrivePhase(double dt) {
-    double currentVel = angularDisplacementPerImpulse / dt;
-    double alpha = (currentVel - previousAngularVelocity) / dt;
-    double torque = calculateTorque(dt, currentVel, alpha);
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::startDrivePhase() {
+    int64_t endCycles = flankBeginCycles();
+    int64_t endImpulse = flankBeginImpulse();
+    T recoveryLen = clock.toSeconds((uint64_t)(endCycles - recoveryPhaseStartCycles));
+    T driveLen = currentData.driveDuration;
+    T recoveryAngle = T((int32_t)(endImpulse - recoveryPhaseStartImpulse)) * settings.angularDisplacementPerImpulse;
+    T driveAngle = T((int32_t)(recoveryPhaseStartImpulse - drivePhaseStartImpulse)) * settings.angularDisplacementPerImpulse;
+    endPhaseWork(); // Recovery work is drag loss, nothing the rower did
 
-    k_mutex_lock(&dataLock, K_FOREVER);
-    currentData.instTorque = torque;
-    currentData.angularAcceleration = alpha;
-    RowingData snapshot = currentData;
-    k_mutex_unlock(&dataLock);
+    if (settings.autoAdjustDragFactor && recoveryDragSampleCount > 0) {
+        // 1. Average the samples collected during the last recovery
+        T avgDragForLastRecovery = recoveryDragAccumulator / T(recoveryDragSampleCount);
+
+        // 2. Limit the step against the learned value (dampingConstantMaxChange, 0 = no limit)
+        if (settings.dampingConstantMaxChange > T(0)) {
+            T lowest = dragFactor * (T(1) - settings.dampingConstantMaxChange);
+            T highest = dragFactor * (T(1) + settings.dampingConstantMaxChange);
+            if (avgDragForLastRecovery < lowest) {
+                avgDragForLastRecovery = lowest;
+            } else if (avgDragForLastRecovery > highest) {
+                avgDragForLastRecovery = highest;
+            }
+        }
+
+        // 3. Median over the last strokes: one bad recovery cannot skew the watts
+        dragFactorMedian.pushValue(avgDragForLastRecovery);
+
+        // 4. Update the learned value so the power calc uses it
+        dragFactor = dragFactorMedian.getMedian();
+
+        // 5. Update the Data struct so the UI sees the new value
+        // (published at the end of handleRotationImpulse)
+    }
+
+    currentData.dragFactor = dragFactor;
+    currentData.recoveryDuration = recoveryLen;
+    currentData.state = RowingState::DRIVE;
+    currentData.strokeCount++;
+
+    // Stroke rate is left to stage 2
+    queueStroke(StrokeRecord{RowingState::DRIVE, driveLen, recoveryLen, driveAngle, recoveryAngle,
+                             T(0), T(0), dragFactor});
+    driveCurve = DriveCurve{};
+
+    drivePhaseStartCycles = endCycles;
+    drivePhaseStartImpulse = endImpulse;
 }
 
-void RowingEngine::startRecoveryPhase(double dt) {
-    double endTime = currentData.totalTime - flankDetector.timeToBeginOfFlank();
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::startRecoveryPhase() {
+    int64_t endCycles = flankBeginCycles();
+    int64_t endImpulse = flankBeginImpulse();
 
-    k_mutex_lock(&dataLock, K_FOREVER);
-    recoveryDragAccumulator = 0.0;
+    recoveryDragAccumulator = T(0);
     recoveryDragSampleCount = 0;
 
-    currentData.driveDuration = endTime - drivePhaseStartTime;
+    T driveWork = endPhaseWork();
+    T driveAngle = T((int32_t)(endImpulse - drivePhaseStartImpulse)) * settings.angularDisplacementPerImpulse;
+    T recoveryAngle = T((int32_t)(drivePhaseStartImpulse - recoveryPhaseStartImpulse)) * settings.angularDisplacementPerImpulse;
+
+    currentData.driveDuration = clock.toSeconds((uint64_t)(endCycles - drivePhaseStartCycles));
     currentData.state = RowingState::RECOVERY;
+    finishDriveCurve(driveAngle, driveWork);
 
-    // ... (Your physics calculations for speed/power) ...
-    double driveImpulses = (currentData.driveDuration / dt);
-    double driveAngle = driveImpulses * angularDisplacementPerImpulse;
-    double recoveryAngle = (currentData.recoveryDuration / dt) * angularDisplacementPerImpulse;
-    double cycleTime = currentData.driveDuration + currentData.recoveryDuration;
+    // Speed, power, distance and averages are left to stage 2
+    queueStroke(StrokeRecord{RowingState::RECOVERY, currentData.driveDuration, currentData.recoveryDuration,
+                             driveAngle, recoveryAngle, driveWork, quality.peakTorque, dragFactor});
 
-    double instSpeed = calculateLinearVelocity(driveAngle, recoveryAngle, cycleTime);
-    double instPower = calculateCyclePower(driveAngle, recoveryAngle, cycleTime);
+    recoveryPhaseStartCycles = endCycles;
+    recoveryPhaseStartImpulse = endImpulse;
+}
 
-    // 1. AUTO-START LOGIC
-    // We check this BEFORE updating averages
-    if (!currentData.sessionActive && instSpeed > 0.1) {
-        // resetSessionInternal();
-        currentData.sessionStartTime = k_uptime_get_32();
-        currentData.sessionActive = true;
+// Closes the phase at the start of the flank: returns its work and
+// carries the work of the flank window over to the phase that begins.
+template<typename T, typename S, typename M>
+T RowingEngine<T, S, M>::endPhaseWork() {
+    T windowWork = T(0);
+    int idx = stepWorkHead;
+    for (int i = 0; i < flankSteps(); i++) {
+        windowWork += stepWork[idx];
+        idx = (idx == 0) ? FLANK_WINDOW_SIZE - 1 : idx - 1;
     }
+    T completed = phaseWork - windowWork;
+    phaseWork = windowWork;
+    return completed;
+}
 
-    // 2. ACCUMULATE SESSION DATA
-    // Only happens if the session is actually running
-    if (currentData.sessionActive) {
-        currentData.instSpeed = instSpeed;
-        currentData.instPower = instPower;
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::addDriveStep(T torque) {
+    DriveCurve &curve = driveCurve;
+    if (curve.steps == 0) {
+        curve.first = torque;
+        curve.peak = torque;
+    } else {
+        T change = torque - curve.last;
+        curve.variation += (change < T(0)) ? -change : change;
+        if (torque > curve.peak) {
+            curve.peak = torque;
+            curve.peakStep = curve.steps;
+        }
+    }
+    curve.last = torque;
+    curve.steps++;
+}
 
-        // Accumulate Distance
-        currentData.distance += (instSpeed * cycleTime);
+// End of the drive: per-stroke quality, then the session consistency. O(1).
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::finishDriveCurve(T driveAngle, T driveWork) {
+    const DriveCurve &curve = driveCurve;
+    T driveLen = currentData.driveDuration;
+    T recoveryLen = currentData.recoveryDuration;
+    T cycleTime = driveLen + recoveryLen;
+
+    quality.driveRecoveryRatio = (recoveryLen > T(0)) ? driveLen / recoveryLen : T(0);
+    quality.peakTorque = curve.peak;
+    quality.peakPosition = (curve.steps > 1) ? T(curve.peakStep) / T(curve.steps - 1) : T(0);
+    // One rise and one fall take exactly this path; bumps and jitter add to it
+    T direct = (curve.peak - curve.first) + (curve.peak - curve.last);
+    quality.smoothness = (curve.variation > T(0)) ? direct / curve.variation : T(1);
+    quality.driveLength = driveAngle;
+    quality.strokePower = (cycleTime > T(0)) ? driveWork / cycleTime : T(0);
+
+    strokePowerStats.push(quality.strokePower);
+    driveLengthStats.push(driveAngle);
+    quality.strokeCount = strokePowerStats.count();
+    quality.powerMean = strokePowerStats.getMean();
+    quality.powerStdDev = strokePowerStats.stdDev();
+    quality.driveLengthMean = driveLengthStats.getMean();
+    quality.driveLengthStdDev = driveLengthStats.stdDev();
+    publishedQuality.publish(quality);
+
+    driveCurve = DriveCurve{};
+}
 
-        // Update Averages (Stroke-based)
-        currentData.strokeSampleCount++;
-        currentData.totalSpmSum += currentData.spm;
-        currentData.totalSpeedSum += instSpeed;
-        currentData.totalPowerSum += instPower;
+// =========================================================
+// Stage 2: stroke-level math
+// =========================================================
 
-        currentData.avgSpm = currentData.totalSpmSum / currentData.strokeSampleCount;
-        currentData.avgSpeed = currentData.totalSpeedSum / currentData.strokeSampleCount;
-        currentData.avgPower = currentData.totalPowerSum / currentData.strokeSampleCount;
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::queueStroke(const StrokeRecord &record) {
+    if (strokeQueue == nullptr) {
+        k_mutex_lock(&strokeLock, K_FOREVER);
+        processStroke(record);
+        k_mutex_unlock(&strokeLock);
+        return;
+    }
 
-        // To handle the time-based inactivity concern:
-        // You should also track 'activeRowingTime' here
-        // currentData.activeSessionTime += cycleTime;
+    atomic_val_t head = atomic_get(&strokeHead);
+    if (head - atomic_get(&strokeTail) >= CONFIG_ORM_STROKE_QUEUE_LENGTH) {
+        atomic_inc(&droppedStrokes);
+        return;
     }
+    strokeRing[head % CONFIG_ORM_STROKE_QUEUE_LENGTH] = record;
+    atomic_set(&strokeHead, head + 1); // Publishes the slot (sequentially consistent)
+    k_work_submit_to_queue(strokeQueue, &strokeWork.work);
+}
+
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::strokeWorkHandler(k_work *work) {
+    StrokeWork *strokeWorkItem = CONTAINER_OF(work, StrokeWork, work);
+    strokeWorkItem->engine->processStrokes();
+}
 
-    k_mutex_unlock(&dataLock);
-    recoveryPhaseStartTime = endTime;
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::processStrokes() {
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    atomic_val_t tail = atomic_get(&strokeTail);
+    while (tail != atomic_get(&strokeHead)) {
+        StrokeRecord record = strokeRing[tail % CONFIG_ORM_STROKE_QUEUE_LENGTH];
+        tail++;
+        atomic_set(&strokeTail, tail); // Frees the slot for stage 1
+        processStroke(record);
+    }
+    k_mutex_unlock(&strokeLock);
 }
 
-void RowingEngine::updateRecoveryPhase(double dt) {
-    double currentVel = angularDisplacementPerImpulse / dt;
-    double alpha = (currentVel - previousAngularVelocity) / dt;
+// Called with strokeLock held
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::processStroke(const StrokeRecord &record) {
+    uint32_t startCycles = k_cycle_get_32();
+
+    if (record.phase == RowingState::DRIVE) {
+        if (record.recoveryDuration >= settings.minimumRecoveryTime && record.driveDuration >= settings.minimumDriveTime) {
+            T cycleTime = record.driveDuration + record.recoveryDuration;
+            strokeData.lastStrokeTime = cycleTime;
+            strokeData.spm = T(60) / cycleTime;
+        }
+    } else if (record.phase == RowingState::PAUSED) {
+        // What a pause cut off: distance, work and energy, but no stroke
+        // of its own for the history and the averages
+        T cycleTime = record.driveDuration + record.recoveryDuration;
+        if (strokeData.sessionActive && cycleTime > T(0)) {
+            T instSpeed = calculateLinearVelocity(record.dragFactor, record.driveAngle, record.recoveryAngle, cycleTime);
+            strokeData.distance += instSpeed * cycleTime;
+            strokeData.totalWork += record.driveWork;
+            strokeSeconds += cycleTime;
+            strokeData.totalEnergy = strokeData.totalWork / settings.joulesPerKcal +
+                                     strokeSeconds * settings.basalEnergyRate / T(3600);
+        }
+    } else {
+        // Angles and work were integrated per impulse by stage 1
+        T cycleTime = record.driveDuration + record.recoveryDuration;
+
+        T instSpeed = calculateLinearVelocity(record.dragFactor, record.driveAngle, record.recoveryAngle, cycleTime);
+        T instPower = (cycleTime > T(0)) ? record.driveWork / cycleTime : T(0);
+        T drivePower = (record.driveDuration > T(0)) ? record.driveWork / record.driveDuration : T(0);
+
+        // 1. AUTO-START LOGIC
+        // We check this BEFORE updating averages
+        if (!strokeData.sessionActive && instSpeed > T(0.1)) {
+            // resetSessionInternal();
+            strokeData.sessionStartTime = k_uptime_get_32();
+            strokeData.sessionActive = true;
+        }
+
+        // 2. ACCUMULATE SESSION DATA
+        // Only happens if the session is actually running
+        if (strokeData.sessionActive) {
+            strokeData.instSpeed = instSpeed;
+            strokeData.instPower = instPower;
+            strokeData.drivePower = drivePower;
+            strokeData.strokeEnergy = record.driveWork;
+
+            // Energy burned, O(1): one divide per stroke
+            strokeData.totalWork += record.driveWork;
+            strokeSeconds += cycleTime;
+            strokeData.totalEnergy = strokeData.totalWork / settings.joulesPerKcal +
+                                     strokeSeconds * settings.basalEnergyRate / T(3600);
+            strokeData.energyPerHour = instPower * T(3600) / settings.joulesPerKcal + settings.basalEnergyRate;
+
+            // Accumulate Distance
+            T strokeDistance = instSpeed * cycleTime;
+            strokeData.distance += strokeDistance;
+
+            // Stroke history and its rolling aggregates, O(1) per stroke
+            if (cycleTime > T(0)) {
+                StrokeSample<T> stroke{record.driveDuration, record.recoveryDuration, strokeDistance,
+                                       record.driveWork, record.drivePeakTorque, record.dragFactor};
+                strokeHistory.push(stroke);
+                workout.onStroke(stroke, k_uptime_get_32());
+                strokeData.recentPower = strokeHistory.recentPower();
+                strokeData.recentPace = strokeHistory.recentPace();
+                strokeData.splitTime = strokeHistory.splitTime();
+                strokeData.strokesPerMinute = strokeHistory.strokesPerMinute();
+            }
+
+            // Update Averages (Stroke-based)
+            strokeData.strokeSampleCount++;
+            strokeData.totalSpmSum += strokeData.spm;
+            strokeData.totalSpeedSum += instSpeed;
+            strokeData.totalPowerSum += instPower;
+
+            T sampleCount(strokeData.strokeSampleCount);
+            strokeData.avgSpm = strokeData.totalSpmSum / sampleCount;
+            strokeData.avgSpeed = strokeData.totalSpeedSum / sampleCount;
+            strokeData.avgPower = strokeData.totalPowerSum / sampleCount;
 
-    // Dynamic Drag Factor Logic
-    if (settings.autoAdjustDragFactor) {
+            // To handle the time-based inactivity concern:
+            // You should also track 'activeRowingTime' here
+            // strokeData.activeSessionTime += cycleTime;
+        }
+    }
+    publishedStroke.publish(strokeData);
+
+    uint32_t cycles = k_cycle_get_32() - startCycles;
+    strokeStats.processed++;
+    strokeStats.totalCycles += cycles;
+    if (cycles > strokeStats.maxCycles) {
+        strokeStats.maxCycles = cycles;
+    }
+}
+
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::updateRecoveryPhase(T currentVel, T alpha) {
+    // Dynamic Drag Factor Logic, not on the shares of a rebuilt gap
+    if (settings.autoAdjustDragFactor && rebuiltInWindow == 0) {
         // Only calculate if flywheel is actually slowing down (alpha < 0)
         // and moving fast enough to avoid low-speed noise (e.g., > 10 rad/s)
-        if (alpha < 0 && currentVel > 10.0) {
+        if (alpha < T(0) && currentVel > T(10)) {
 
-            // Physics Formula: k = (I * -alpha) / w^2
-            double rawDrag = (settings.flywheelInertia * -alpha) / (currentVel * currentVel);
+            // Physics Formula: I * -alpha = drag torque (k * w^2 for air and water)
+            T rawDrag = M::Resistance::dragFromDeceleration(settings.flywheelInertia, alpha, currentVel);
 
             // Sanity Check: Ignore wild outliers (e.g. sensor noise causing massive spikes)
-            // A drag factor > 0.1 is physically impossible for a rower (usually 0.0001 - 0.005)
-            if (rawDrag > 0.0 && rawDrag < 0.1) {
+            if (rawDrag > T(0) && rawDrag < M::Resistance::maximumDrag()) {
                 recoveryDragAccumulator += rawDrag;
                 recoveryDragSampleCount++;
             }
         }
     }
-    double torque = calculateTorque(dt, currentVel, alpha);
+}
 
+// Torque, power and work of one analysis step, in either phase. O(1).
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::integrateStep(T currentVel, T alpha) {
+    T torque = calculateTorque(currentVel, alpha);
+
+    // Work = integral of torque over the angle of the step. The drag part
+    // is torque x angle; the inertia part integrates exactly to the change
+    // in kinetic energy, so it does not pick up the noise of alpha.
+    T work = T(0.5) * settings.flywheelInertia *
+                 (currentVel * currentVel - previousAngularVelocity * previousAngularVelocity) +
+             M::Resistance::torque(dragFactor, currentVel) * settings.angularDisplacementPerStep;
+    previousAngularVelocity = currentVel;
+
+    // The oldest step of the window leaves it now, its phase is settled
+    if (currentData.state == RowingState::DRIVE) {
+        int leaving = stepWorkHead - (flankSteps() - 1);
+        if (leaving < 0) leaving += FLANK_WINDOW_SIZE;
+        addDriveStep(stepTorque[leaving]);
+    }
+
+    stepWorkHead = (stepWorkHead + 1 == FLANK_WINDOW_SIZE) ? 0 : stepWorkHead + 1;
+    stepWork[stepWorkHead] = work;
+    stepTorque[stepWorkHead] = torque;
+    phaseWork += work;
+    totalImpulses += settings.impulsesPerStep;
 
-    k_mutex_lock(&dataLock, K_FOREVER);
-    currentData.angularAcceleration = alpha;
     currentData.instTorque = torque;
-    RowingData snapshot = currentData;
-    k_mutex_unlock(&dataLock);
+    currentData.angularAcceleration = alpha;
+    currentData.impulsePower = torque * currentVel;
 }
 
-double RowingEngine::calculateTorque(double dt, double currentVel, double alpha) {
-    double torque = settings.flywheelInertia * alpha + settings.dragFactor * std::pow(currentVel, 2);
-    previousAngularVelocity = currentVel;
-    return torque;
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::estimateFlywheelState(T dt, T &currentVel, T &alpha) {
+    if constexpr (FlankDetector<T, S>::estimatesState) {
+        // Filtered estimate, no differencing of raw impulses
+        currentVel = flankDetector.angularVelocity();
+        alpha = flankDetector.angularAcceleration();
+    } else {
+        currentVel = settings.angularDisplacementPerStep / dt;
+        alpha = (currentVel - previousAngularVelocity) / dt;
+    }
 }
 
-double RowingEngine::calculateLinearVelocity(double driveAngle, double recoveryAngle, double cycleTime) {
-    if (cycleTime <= 0) return 0;
-    double totalAngle = driveAngle + recoveryAngle;
-    double factor = std::pow(settings.dragFactor / settings.magicConstant, 1.0/3.0);
-    return factor * (totalAngle / cycleTime);
+template<typename T, typename S, typename M>
+T RowingEngine<T, S, M>::calculateTorque(T currentVel, T alpha) {
+    return settings.flywheelInertia * alpha + M::Resistance::torque(dragFactor, currentVel);
 }
 
-double RowingEngine::calculateCyclePower(double driveAngle, double recoveryAngle, double cycleTime) {
-    if (cycleTime <= 0) return 0;
-    double totalAngle = driveAngle + recoveryAngle;
-    double avgAngularVel = totalAngle / cycleTime;
-    return settings.dragFactor * std::pow(avgAngularVel, 3.0);
+template<typename T, typename S, typename M>
+T RowingEngine<T, S, M>::calculateLinearVelocity(T drag, T driveAngle, T recoveryAngle, T cycleTime) {
+    if (cycleTime <= T(0)) return T(0);
+    return M::Distance::linearVelocity(settings, drag, driveAngle + recoveryAngle, cycleTime);
 }
 
-void RowingEngine::resetSessionInternal() {
-    currentData = RowingData();
-    currentData.dragFactor = settings.dragFactor;
+// Called with writeLock and strokeLock held
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::resetSessionInternal() {
+    currentData = RowingData<T>();
+    currentData.dragFactor = dragFactor;
     currentData.state = RowingState::RECOVERY;
-    dragFactorAverager.reset(settings.dragFactor);
+    strokeData = RowingData<T>();
+    strokeHistory.reset();
+    strokeSeconds = T(0);
+    atomic_set(&strokeTail, atomic_get(&strokeHead));
+    dragFactorMedian.reset(dragFactor);
 
     // Clear stale drag accumulation from previous session
-    recoveryDragAccumulator = 0.0;
+    recoveryDragAccumulator = T(0);
     recoveryDragSampleCount = 0;
 
-    // Pre-seed phase timing so first stroke produces valid cycleTime
-    double plausibleDisplacement = 8.0 / std::pow(settings.dragFactor / settings.magicConstant, 1.0/3.0);
-    recoveryPhaseStartTime = -2.0 * settings.minimumRecoveryTime;
-    recoveryPhaseStartAngularDisplacement = -1.0 * (2.0/3.0) * plausibleDisplacement / angularDisplacementPerImpulse;
-    previousAngularVelocity = 0;
+    // Restart the time base and the integrals, this also pre-seeds the first recovery
+    resetPhaseState();
+    resetStrokeQuality();
+
+    publishedStroke.publish(strokeData);
+    publishedData.publish(currentData);
 }
 
-void RowingEngine::startSession() {
-    k_mutex_lock(&dataLock, K_FOREVER);
-    if (!currentData.sessionActive) {
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::startSession() {
+    k_mutex_lock(&writeLock, K_FOREVER);
+    k_mutex_lock(&strokeLock, K_FOREVER);
+    if (!strokeData.sessionActive) {
         LOG_INF("Starting session.");
         resetSessionInternal();
     }
-    k_mutex_unlock(&dataLock);
+    k_mutex_unlock(&strokeLock);
+    k_mutex_unlock(&writeLock);
 }
 
-void RowingEngine::endSession() {
-    k_mutex_lock(&dataLock, K_FOREVER);
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::endSession() {
+    k_mutex_lock(&writeLock, K_FOREVER);
+    k_mutex_lock(&strokeLock, K_FOREVER);
     resetSessionInternal();
     LOG_INF("Session ended.");
-    k_mutex_unlock(&dataLock);
+    k_mutex_unlock(&strokeLock);
+    k_mutex_unlock(&writeLock);
 }
 
-void RowingEngine::printData() {
-    k_mutex_lock(&dataLock, K_FOREVER);
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::printData() {
+    RowingData<T> data = getData();
     // currentData.spm = 25.1;
     // currentData.strokeCount = 300;
     // currentData.avgSpm = 25.0;
@@ -306,27 +929,43 @@ void RowingEngine::printData() {
     // currentData.avgPower = 100.1;
     // currentData.sessionActive = true;
     // currentData.sessionStartTime = 0
-    printk("\nStroke Rate: %f\n", currentData.spm);
-    printk("Stroke Count: %d\n", currentData.strokeCount);
-    printk("Average Stroke Rate: %f\n", currentData.avgSpm);
-    printk("Distance: %f\n", currentData.distance);
-    printk("Pace: %f\n", currentData.instSpeed);
-    printk("Average Pace: %f\n", currentData.avgSpeed);
-    printk("Power: %f\n", currentData.instPower);
-    printk("Average Power: %f\n", currentData.avgPower);
-    printk("Drag factor: %f\n", currentData.dragFactor);
-    k_mutex_unlock(&dataLock);
-}
-
-void RowingEngine::logDragFactor() {
-    k_mutex_lock(&dataLock, K_FOREVER);
+    printk("\nStroke Rate: %f\n", static_cast<double>(data.spm));
+    printk("Stroke Count: %d\n", data.strokeCount);
+    printk("Average Stroke Rate: %f\n", static_cast<double>(data.avgSpm));
+    printk("Distance: %f\n", static_cast<double>(data.distance));
+    printk("Pace: %f\n", static_cast<double>(data.instSpeed));
+    printk("Average Pace: %f\n", static_cast<double>(data.avgSpeed));
+    printk("Power: %f\n", static_cast<double>(data.instPower));
+    printk("Average Power: %f\n", static_cast<double>(data.avgPower));
+    printk("Drag factor: %f\n", static_cast<double>(data.dragFactor));
+}
+
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::logDragFactor() {
+    RowingData<T> data = getData();
     // LOG_INF("Drag factor: %f", currentData.dragFactor);
-    LOG_INF("Session Active: %d", currentData.sessionActive);
-    k_mutex_unlock(&dataLock);
+    LOG_INF("Session Active: %d", data.sessionActive);
 }
 
-void RowingEngine::printSettings() {
-    LOG_INF("Fly wheel inertia: %f", settings.flywheelInertia);
-    LOG_INF("Magic constant: %f", settings.magicConstant);
-    LOG_INF("Drag factor: %f", settings.dragFactor);
+template<typename T, typename S, typename M>
+void RowingEngine<T, S, M>::printSettings() {
+    LOG_INF("Fly wheel inertia: %f", static_cast<double>(settings.flywheelInertia));
+    LOG_INF("Magic constant: %f", static_cast<double>(settings.magicConstant));
+    LOG_INF("Drag factor: %f", static_cast<double>(settings.dragFactor));
+    LOG_INF("Flank detector: %s", FLANK_DETECTOR_NAME);
+    LOG_INF("Rower model: %s", M::name);
 };
+
+// Explicit instantiations for every arithmetic type the engine can be built with,
+// with both settings types and every rower model
+#define ORM_INSTANTIATE_ENGINE(Model) \
+    template class RowingEngine<double, RowingSettings<double>, Model<double>>; \
+    template class RowingEngine<float, RowingSettings<float>, Model<float>>; \
+    template class RowingEngine<Fixed, RowingSettings<Fixed>, Model<Fixed>>; \
+    template class RowingEngine<double, StaticRowingSettings<double>, Model<double>>; \
+    template class RowingEngine<float, StaticRowingSettings<float>, Model<float>>; \
+    template class RowingEngine<Fixed, StaticRowingSettings<Fixed>, Model<Fixed>>;
+
+ORM_INSTANTIATE_ENGINE(AirRowerModel)
+ORM_INSTANTIATE_ENGINE(MagneticRowerModel)
+ORM_INSTANTIATE_ENGINE(WaterRowerModel)
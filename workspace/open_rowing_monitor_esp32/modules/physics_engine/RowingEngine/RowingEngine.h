@@ -2,54 +2,275 @@
 
 #include <zephyr/kernel.h>
 #include "RowingSettings.h"
+#include "SettingsStore.h"
 #include "MovingFlankDetector.h"
+#include "RegressionFlankDetector.h"
+#include "KalmanFlankDetector.h"
 #include "RowingData.h"
-#include "MovingAverager.h"
+#include "SeqLock.h"
+#include "StrokeHistory.h"
+#include "RunningVariance.h"
+#include "WorkoutEngine.h"
+#include "MovingMedian.h"
+#include "RowerModel.h"
+#include "LearnedState.h"
 
+// Work queue that runs the stroke stage of every engine attached to it
+// (started on first use, see CONFIG_ORM_STROKE_WORKQ_*).
+k_work_q *rowingStrokeWorkQueue();
+
+// Stroke stage counters, for the physics profiling report
+struct StrokeStageStats {
+    uint32_t processed;     // Stroke records turned into metrics
+    uint32_t dropped;       // Records lost because the queue was full
+    uint32_t maxCycles;     // Worst-case cycles for one record
+    uint64_t totalCycles;
+};
+
+// Flank detector, selected in Kconfig (same interface)
+#if defined(CONFIG_ORM_FLANK_DETECTOR_REGRESSION)
+    template<typename T, typename S> using FlankDetector = RegressionFlankDetector<T, S>;
+    #define FLANK_DETECTOR_NAME "regression"
+#elif defined(CONFIG_ORM_FLANK_DETECTOR_KALMAN)
+    template<typename T, typename S> using FlankDetector = KalmanFlankDetector<T, S>;
+    #define FLANK_DETECTOR_NAME "kalman"
+#else
+    template<typename T, typename S> using FlankDetector = MovingFlankDetector<T, S>;
+    #define FLANK_DETECTOR_NAME DefaultFlankFilter<PhysicsScalar>::name
+#endif
+
+// Impulses the flank detectors look back over
+#define FLANK_WINDOW_SIZE (CONFIG_ORM_FLANK_LENGTH + 1)
+
+// Drag factor median window, sized from Kconfig
+#ifdef CONFIG_ORM_AUTO_ADJUST_DRAG_FACTOR
+    #define DRAG_MEDIAN_SIZE CONFIG_ORM_DAMPING_CONSTANT_SMOOTING
+#else
+    #define DRAG_MEDIAN_SIZE 1
+#endif
+
+/**
+ * S is the settings type: RowingSettings<T> for values that can change at
+ * runtime, StaticRowingSettings<T> to fold the Kconfig values into the code.
+ * DefaultRowingSettings<T> follows CONFIG_ORM_SETTINGS_COMPILE_TIME.
+ * The engine keeps its own copy of the settings. With RowingSettings it
+ * can follow a SettingsStore: a new version is copied in between two
+ * impulses, so a stroke never sees two values of one setting.
+ * M is the rower model (resistance, drag estimator, distance), see
+ * RowerModel.h; DefaultRowerModel<T> follows CONFIG_ORM_ROWER_MODEL.
+ */
+template<typename T = PhysicsScalar, typename S = DefaultRowingSettings<T>, typename M = DefaultRowerModel<T>>
 class RowingEngine {
 private:
-    RowingSettings &settings;
-    MovingFlankDetector flankDetector;
-    MovingAverager dragFactorAverager;
+    // Stage 1 reads it on the physics thread, stage 2 under strokeLock;
+    // refreshSettings() replaces it under both locks
+    S settings;
+    const SettingsStore<S> *settingsStore = nullptr;
+    uint32_t settingsVersion = 0;
+    FlankDetector<T, S> flankDetector;
+    MovingMedian<DRAG_MEDIAN_SIZE, T> dragFactorMedian;
 
     // Data Protection
-    mutable k_mutex dataLock; // Mutable allows locking even in 'const' functions
-    RowingData currentData;
+    // Stage 1 (physics thread) owns currentData: phase, timing, torque and
+    // the drag factor. Stage 2 (stroke work queue, or inline) owns the
+    // stroke-level fields of strokeData. Each side publishes its own
+    // SeqLock; getData() merges the two, so readers never block.
+    // Session control takes writeLock then strokeLock.
+    k_mutex writeLock;
+    mutable k_mutex strokeLock;
+    RowingData<T> currentData;
+    RowingData<T> strokeData;
+    SeqLock<RowingData<T>> publishedData;
+    SeqLock<RowingData<T>> publishedStroke;
+
+    // Phase change handed from stage 1 to stage 2
+    struct StrokeRecord {
+        RowingState phase;      // Phase that just started, PAUSED for the rest a pause cuts off
+        T driveDuration;
+        T recoveryDuration;
+        T driveAngle;           // Radians turned during the drive...
+        T recoveryAngle;        // ...and the recovery before it
+        T driveWork;            // Joules put in during the drive
+        T drivePeakTorque;      // Highest torque of the drive
+        T dragFactor;           // Drag factor in effect for this stroke
+    };
+
+    // Single-producer / single-consumer ring between the stages
+    StrokeRecord strokeRing[CONFIG_ORM_STROKE_QUEUE_LENGTH];
+    atomic_t strokeHead = ATOMIC_INIT(0); // Written by stage 1 only
+    // Advanced by stage 2 in processStrokes(), which holds strokeLock for
+    // the whole drain. reset() and resetSessionInternal() also move it up
+    // to the head to drop pending records. They hold writeLock (no new
+    // head) and strokeLock (no drain in flight). Any other writer must
+    // hold both.
+    atomic_t strokeTail = ATOMIC_INIT(0);
+
+    struct StrokeWork {
+        k_work work;
+        RowingEngine *engine;
+    } strokeWork;
+    k_work_q *strokeQueue = nullptr; // nullptr: stage 2 runs inline on the physics thread
+
+    StrokeStageStats strokeStats{};      // Under strokeLock
+    StrokeHistory<CONFIG_ORM_STROKE_HISTORY_LENGTH, T> strokeHistory{CONFIG_ORM_RECENT_STROKE_COUNT}; // Under strokeLock
+    WorkoutEngine<T> workout;            // Under strokeLock, outlives session resets
+    T strokeSeconds{};                   // Under strokeLock, cycle time of the session's strokes (basal energy)
+    atomic_t droppedStrokes = ATOMIC_INIT(0); // Counted by stage 1
+    atomic_t missedImpulseCount = ATOMIC_INIT(0); // Lost before the queue, counted by stage 1
+
+    // Time base: timer cycles, converted to seconds only for what is published
+    CycleClock<T> clock;
+    uint32_t minimumImpulseCycles;
+    uint32_t maximumImpulseCycles;
+    uint32_t minimumDriveCycles;
+    uint32_t minimumRecoveryCycles;
+    int64_t totalCycles = 0;
+    uint32_t totalSeconds = 0;      // totalCycles split into whole seconds...
+    uint32_t subSecondCycles = 0;   // ...and the rest, for totalTime without a divide
+    uint32_t lastImpulseCycles = 0; // Last accepted impulse, the pace a gap is rebuilt at
+    bool rebuilding = false;        // Impulses of a rebuilt gap are being fed
+    int rebuiltInWindow = 0;        // Impulses until the flank window holds no rebuilt one
 
     // Internal State
-    double angularDisplacementPerImpulse;
-    double drivePhaseStartTime = 0;
-    double drivePhaseStartAngularDisplacement = 0;
-    double recoveryPhaseStartTime = 0;
-    double recoveryPhaseStartAngularDisplacement = 0;
-    double previousAngularVelocity = 0;
+    T dragFactor; // Learned drag factor (starts at settings.dragFactor, or a restored LearnedState)
+    int64_t drivePhaseStartCycles = 0;
+    int64_t drivePhaseStartImpulse = 0;
+    int64_t recoveryPhaseStartCycles = 0;
+    int64_t recoveryPhaseStartImpulse = 0;
+    bool waitingForDrive = false;   // After a pause: the next drive opens the phases, it ends no stroke
+    T previousAngularVelocity{};
+
+    // Work integration. A phase change is dated back to the start of the
+    // flank, so the work of the flank window belongs to the new phase:
+    // keep the last window per analysis step and split it off at the change.
+    int64_t totalImpulses = 0;          // Accepted impulses this session
+    T stepWork[FLANK_WINDOW_SIZE]{};    // Joules per step, ring
+    int stepWorkHead = 0;
+    T phaseWork{};                      // Since the current phase started
+
+    // Stroke quality. A step joins the drive curve when it leaves the
+    // flank window, once its phase is settled: the curve then runs from
+    // the start of the drive flank to the start of the recovery flank.
+    T stepTorque[FLANK_WINDOW_SIZE]{};  // N·m per step, same ring as stepWork
+    struct DriveCurve {
+        int steps;
+        int peakStep;
+        T peak;
+        T first;
+        T last;
+        T variation;                    // Sum of |torque change| between steps
+    } driveCurve{};
+    RunningVariance<T> strokePowerStats;
+    RunningVariance<T> driveLengthStats;
+    StrokeQualityData<T> quality;       // Stage 1
+    SeqLock<StrokeQualityData<T>> publishedQuality;
 
     uint32_t impulseCount = 0;
 
     // Automatic dragfactor
-    double recoveryDragAccumulator = 0.0;
+    T recoveryDragAccumulator{};
     int recoveryDragSampleCount = 0;
+    // Analysis step being filled: settings.impulsesPerStep impulses make
+    // one value for the flank detector, the rings and the drag, so they
+    // span the same angle at any bin size
+    uint32_t stepCycles = 0;
+    int stepImpulses = 0;
+    bool stepRebuilt = false;           // Holds a share of a rebuilt gap
 
     // Helpers
-    double calculateLinearVelocity(double driveAngle, double recoveryAngle, double cycleTime);
-    double calculateCyclePower(double driveAngle, double recoveryAngle, double cycleTime);
-    double calculateTorque(double dt, double currentVel, double alpha);
-
-    void startDrivePhase(double dt);
-    void updateDrivePhase(double dt);
-    void startRecoveryPhase(double dt);
-    void updateRecoveryPhase(double dt);
+    T calculateLinearVelocity(T drag, T driveAngle, T recoveryAngle, T cycleTime);
+    T calculateTorque(T currentVel, T alpha);
+    void estimateFlywheelState(T dt, T &currentVel, T &alpha);
+    void integrateStep(T currentVel, T alpha);
+    T endPhaseWork();
+    void addDriveStep(T torque);
+    void finishDriveCurve(T driveAngle, T driveWork);
+    void resetStrokeQuality();
+
+    void startDrivePhase();
+    void startFirstDrive();
+    void startRecoveryPhase();
+    void updateRecoveryPhase(T currentVel, T alpha);
     void resetSessionInternal();
+    void resetPhaseState();
+    void restartPhases();
+    void resumeFromPause();
+    void refreshSettings();
+    uint32_t learnedFingerprint() const;
+    // Session time, in cycles, of the impulse the current flank starts at
+    int64_t flankBeginCycles() { return totalCycles - (int64_t)flankDetector.cyclesToBeginOfFlank(); }
+    // Steps in the flank window (settings.flankLength clamped the way the detectors do)
+    int flankSteps() const {
+        int len = settings.flankLength;
+        if (len >= FLANK_WINDOW_SIZE) len = FLANK_WINDOW_SIZE - 1;
+        return ((len < 1) ? 1 : len) + 1;
+    }
+    int64_t flankBeginImpulse() const { return totalImpulses - (int64_t)flankSteps() * settings.impulsesPerStep; }
+
+    // Stage 2
+    void queueStroke(const StrokeRecord &record);
+    void processStroke(const StrokeRecord &record);
+    void processStrokes();
+    static void strokeWorkHandler(k_work *work);
 public:
-    explicit RowingEngine(RowingSettings &rs);
+    // cyclesPerSec: rate of the counter the impulse deltas come from
+    explicit RowingEngine(const S &rs, uint32_t cyclesPerSec = sys_clock_hw_cycles_per_sec());
     void startSession();
     void endSession();
 
-    void handleRotationImpulse(double dt);
+    // Time since the previous impulse, in k_cycle_get_32() cycles
+    void handleRotationImpulse(uint32_t deltaCycles);
+    // An impulse after missedImpulses the impulse queue lost (ImpulseSample.h):
+    // deltaCycles spans them all and is spread over missedImpulses + 1
+    // impulses, ramping from the last pace, each one inside the gate
+    void handleRotationImpulse(uint32_t deltaCycles, uint32_t missedImpulses);
+    // Impulses lost upstream since start
+    uint32_t getMissedImpulses() const { return (uint32_t)atomic_get(&missedImpulseCount); }
+    // The gate of handleRotationImpulse(), in cycles: impulses outside it are dropped
+    uint32_t getMinimumImpulseCycles() const { return minimumImpulseCycles; }
+    uint32_t getMaximumImpulseCycles() const { return maximumImpulseCycles; }
+    // No impulse for settings.maximumImpulseTimeBeforePause: zeroes the live
+    // metrics and stops the clock until the next impulse. Physics thread only.
+    void handleImpulseTimeout();
+    // How long the physics loop waits for an impulse before calling handleImpulseTimeout()
+    uint32_t impulseTimeoutMs() const {
+        return (uint32_t)(static_cast<double>(settings.maximumImpulseTimeBeforePause) * 1000.0 + 0.5);
+    }
+    // Back to an empty session, starting from the learned drag factor
     void reset();
 
-    // Thread-Safe Accessor
-    RowingData getData();
+    // The learned drag factor, for the next session and the next boot
+    // (lock-free on the physics thread's side, see LearnedState.h)
+    LearnedState getLearnedState() const;
+    // Starts from a saved state, through reset(), if it was learned on this
+    // rower model and calibration. Returns false and keeps the drag factor
+    // otherwise. Call before rowing starts.
+    bool restoreLearnedState(const LearnedState &state);
+
+    // Takes every new version of the store at the next impulse (RowingSettings
+    // only, StaticRowingSettings cannot change). Call before rowing starts.
+    void followSettings(const SettingsStore<S> &store);
+
+    // Moves stage 2 onto a work queue (nullptr: back to inline). Call before rowing starts.
+    void setStrokeWorkQueue(k_work_q *queue);
+    // Waits until every queued stroke record has been processed
+    void flushStrokes();
+    StrokeStageStats getStrokeStageStats() const;
+    // Copies up to max completed strokes of the session, newest first. Returns the count.
+    int getStrokeHistory(StrokeSample<T> *out, int max) const;
+
+    // Interval workout fed by the completed strokes (see WorkoutEngine.h)
+    void startWorkout(const WorkoutProgram &program);
+    void stopWorkout();
+    WorkoutStatus<T> getWorkoutStatus() const;
+    // Result of interval i of the workout, false if there is no such interval
+    bool getIntervalSplit(int i, IntervalSplit<T> &split) const;
+
+    // Thread-Safe Accessor (lock-free, see SeqLock)
+    RowingData<T> getData() const;
+    uint32_t getReaderRetries() const;
+    // Stroke quality of the last stroke and the session (lock-free, see SeqLock)
+    StrokeQualityData<T> getStrokeQuality() const { return publishedQuality.read(); }
     void printData();
     void logDragFactor();
     void printSettings();
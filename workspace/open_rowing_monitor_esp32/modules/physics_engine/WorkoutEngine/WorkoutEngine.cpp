@@ -0,0 +1,133 @@
+#include "WorkoutEngine.h"
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(WorkoutEngine, LOG_LEVEL_INF);
+
+template<typename T>
+void WorkoutEngine<T>::start(const WorkoutProgram &newProgram) {
+    program = newProgram;
+    if (program.count > CONFIG_ORM_WORKOUT_MAX_INTERVALS) {
+        LOG_WRN("Workout of %d intervals > Max %d. Clamping.", program.count, CONFIG_ORM_WORKOUT_MAX_INTERVALS);
+        program.count = CONFIG_ORM_WORKOUT_MAX_INTERVALS;
+    }
+    for (int i = 0; i < program.count; i++) {
+        // An empty interval would never end
+        if (program.intervals[i].amount == 0) program.intervals[i].amount = 1;
+        splits[i] = IntervalSplit<T>{};
+    }
+    if (program.count == 0) {
+        state = WorkoutState::IDLE;
+        return;
+    }
+    beginInterval(0);
+    LOG_INF("Workout started: %d intervals", program.count);
+}
+
+template<typename T>
+void WorkoutEngine<T>::stop() {
+    state = WorkoutState::IDLE;
+}
+
+template<typename T>
+void WorkoutEngine<T>::beginInterval(int index) {
+    current = index;
+    splits[index] = IntervalSplit<T>{};
+    state = WorkoutState::WORK;
+}
+
+template<typename T>
+void WorkoutEngine<T>::finishInterval(uint32_t nowMs) {
+    const IntervalSplit<T> &split = splits[current];
+    LOG_INF("Interval %d: %.1f s, %.1f m, pace %.1f s/500m", current + 1, static_cast<double>(split.time),
+            static_cast<double>(split.distance), static_cast<double>(split.avgPace()));
+
+    uint16_t rest = program.intervals[current].restSeconds;
+    if (current + 1 >= program.count) {
+        state = WorkoutState::DONE;
+    } else if (rest > 0) {
+        state = WorkoutState::REST;
+        restEndMs = nowMs + (uint32_t)rest * 1000u;
+    } else {
+        beginInterval(current + 1);
+    }
+}
+
+template<typename T>
+T WorkoutEngine<T>::amountOf(const StrokeSample<T> &stroke, IntervalTarget target) {
+    switch (target) {
+        case IntervalTarget::TIME:      return stroke.cycleTime();
+        case IntervalTarget::DISTANCE:  return stroke.distance;
+        default:                        return T(1);
+    }
+}
+
+template<typename T>
+T WorkoutEngine<T>::progressOf(const IntervalSplit<T> &split, IntervalTarget target) {
+    switch (target) {
+        case IntervalTarget::TIME:      return split.time;
+        case IntervalTarget::DISTANCE:  return split.distance;
+        default:                        return split.strokes;
+    }
+}
+
+template<typename T>
+void WorkoutEngine<T>::onStroke(const StrokeSample<T> &stroke, uint32_t nowMs) {
+    if (state == WorkoutState::REST) {
+        if ((int32_t)(nowMs - restEndMs) < 0) return;
+        beginInterval(current + 1);
+    }
+
+    // Share of the stroke not placed in an interval yet
+    T unplaced = T(1);
+    while (state == WorkoutState::WORK) {
+        const WorkoutInterval &interval = program.intervals[current];
+        IntervalSplit<T> &split = splits[current];
+
+        T strokeAmount = amountOf(stroke, interval.target);
+        T left = T(interval.amount) - progressOf(split, interval.target);
+        T share = unplaced;
+        bool finished = (strokeAmount * unplaced >= left);
+        if (finished) {
+            share = (strokeAmount > T(0)) ? left / strokeAmount : T(0);
+        }
+
+        split.time += stroke.cycleTime() * share;
+        split.distance += stroke.distance * share;
+        split.energy += stroke.energy * share;
+        split.strokes += share;
+        unplaced -= share;
+
+        if (!finished) return;
+        // The rest of the stroke goes to the next interval, unless there is a rest in between
+        finishInterval(nowMs);
+    }
+}
+
+template<typename T>
+WorkoutStatus<T> WorkoutEngine<T>::getStatus(uint32_t nowMs) const {
+    WorkoutStatus<T> status{};
+    status.state = state;
+    status.interval = current;
+    if (state == WorkoutState::IDLE) return status;
+
+    status.split = splits[current];
+    const WorkoutInterval &interval = program.intervals[current];
+    if (state == WorkoutState::REST) {
+        int32_t restLeft = (int32_t)(restEndMs - nowMs);
+        status.interval = current + 1;
+        status.remaining = (restLeft > 0) ? T(restLeft) / T(1000) : T(0);
+        status.split = IntervalSplit<T>{};
+        return status;
+    }
+    if (state == WorkoutState::WORK) {
+        status.remaining = T(interval.amount) - progressOf(status.split, interval.target);
+    }
+    if (interval.targetPace > 0 && status.split.distance > T(0)) {
+        status.paceDelta = status.split.avgPace() - T((int32_t)interval.targetPace) / T(10);
+    }
+    return status;
+}
+
+template class WorkoutEngine<double>;
+template class WorkoutEngine<float>;
+template class WorkoutEngine<Fixed>;
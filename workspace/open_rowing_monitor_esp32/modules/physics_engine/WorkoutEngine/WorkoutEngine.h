@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <zephyr/kernel.h>
+
+#include "PhysicsScalar.h"
+#include "StrokeHistory.h"
+
+// What ends a work interval
+enum class IntervalTarget : uint8_t {
+    TIME,       // Seconds of rowing
+    DISTANCE,   // Meters
+    STROKES
+};
+
+// One row of a workout table
+struct WorkoutInterval {
+    uint32_t amount;        // Seconds, meters or strokes, by target
+    uint16_t restSeconds;   // Rest after the interval, 0 = straight into the next one
+    uint16_t targetPace;    // Seconds per 500 m x10, 0 = no target
+    IntervalTarget target;
+};
+
+struct WorkoutProgram {
+    uint8_t count;
+    WorkoutInterval intervals[CONFIG_ORM_WORKOUT_MAX_INTERVALS];
+};
+
+enum class WorkoutState : uint8_t {
+    IDLE,
+    WORK,
+    REST,
+    DONE
+};
+
+// What was rowed in one interval. A stroke that crosses the end of an
+// interval is split between the two in proportion to the target.
+template<typename T = PhysicsScalar>
+struct IntervalSplit {
+    T time;         // Seconds of rowing
+    T distance;     // Meters
+    T energy;       // Joules
+    T strokes;
+
+    T avgPower() const { return (time > T(0)) ? energy / time : T(0); }
+    T avgPace() const { return (distance > T(0)) ? time * T(500) / distance : T(0); }
+    T avgSpm() const { return (time > T(0)) ? strokes * T(60) / time : T(0); }
+};
+
+template<typename T = PhysicsScalar>
+struct WorkoutStatus {
+    WorkoutState state;
+    int interval;           // Interval in progress (the next one while resting)
+    T remaining;            // Left of the interval in its unit; seconds while resting
+    T paceDelta;            // Average pace minus target, s/500 m (negative = ahead); 0 without target
+    IntervalSplit<T> split; // Interval in progress so far
+};
+
+/**
+ * @brief Interval workout run on the completed strokes of one engine.
+ * * A program is a fixed table of work intervals that end after a time,
+ * distance or stroke count, each followed by an optional rest. The engine
+ * hands every completed stroke to onStroke() (stage 2, under its stroke
+ * lock): it adds the stroke to the interval in progress and moves to the
+ * next interval at the exact boundary, splitting the crossing stroke.
+ * Work per stroke is O(1) (a stroke crossing several short intervals
+ * touches each once). Rest is wall time: strokes before its end are
+ * ignored and the first stroke after it starts the next interval.
+ */
+template<typename T = PhysicsScalar>
+class WorkoutEngine {
+private:
+    WorkoutProgram program{};
+    WorkoutState state = WorkoutState::IDLE;
+    int current = 0;
+    uint32_t restEndMs = 0;
+    IntervalSplit<T> splits[CONFIG_ORM_WORKOUT_MAX_INTERVALS]{};
+
+    static T amountOf(const StrokeSample<T> &stroke, IntervalTarget target);
+    static T progressOf(const IntervalSplit<T> &split, IntervalTarget target);
+    void beginInterval(int index);
+    void finishInterval(uint32_t nowMs);
+
+public:
+    // Starts the program from its first interval (intervals past count are ignored)
+    void start(const WorkoutProgram &newProgram);
+    void stop();
+
+    void onStroke(const StrokeSample<T> &stroke, uint32_t nowMs);
+
+    WorkoutStatus<T> getStatus(uint32_t nowMs) const;
+    WorkoutState getState() const { return state; }
+    int intervalCount() const { return program.count; }
+    // Result of interval i (zero until it starts)
+    const IntervalSplit<T> &getSplit(int i) const { return splits[i]; }
+};
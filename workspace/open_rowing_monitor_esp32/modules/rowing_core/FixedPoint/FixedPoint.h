@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <zephyr/kernel.h> // Required to see CONFIG_ macros
+
+#ifdef CONFIG_ORM_FIXED_POINT_FRAC_BITS
+    #define ORM_FIXED_FRAC_BITS CONFIG_ORM_FIXED_POINT_FRAC_BITS
+#else
+    #define ORM_FIXED_FRAC_BITS 32
+#endif
+
+/**
+ * @brief Signed Q-format number stored in 64 bits.
+ *
+ * With the default 32 fractional bits (Q31.32) the range is +/-2.1e9 and the
+ * resolution 2.3e-10, which covers drag factors around 1e-5 as well as
+ * session distances and stroke sums with the same type.
+ *
+ * Products and quotients need a 128-bit intermediate. Hosts with __int128 use
+ * it directly; the ESP32-S3 (Xtensa) builds it from 32-bit partial products.
+ *
+ * All conversions are explicit so float/double never sneaks into the hot path.
+ */
+class Fixed {
+public:
+    static constexpr int FRAC_BITS = ORM_FIXED_FRAC_BITS;
+    static constexpr int64_t ONE = (int64_t)1 << FRAC_BITS;
+
+    static_assert(FRAC_BITS >= 16 && FRAC_BITS <= 32, "Fixed supports 16..32 fractional bits");
+
+    constexpr Fixed() : raw(0) {}
+    constexpr explicit Fixed(double v) : raw((int64_t)(v * (double)ONE + (v >= 0 ? 0.5 : -0.5))) {}
+    constexpr explicit Fixed(float v) : raw((int64_t)(v * (float)ONE)) {}
+
+    template<typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+    constexpr explicit Fixed(I v) : raw((int64_t)v * ONE) {}
+
+    static constexpr Fixed fromRaw(int64_t r) {
+        Fixed f;
+        f.raw = r;
+        return f;
+    }
+
+    // num / den without leaving integer arithmetic (e.g. cycles / cycles-per-second)
+    static Fixed fromRatio(uint32_t num, uint32_t den) {
+        return fromRaw((int64_t)(((uint64_t)num << FRAC_BITS) / den));
+    }
+
+    constexpr int64_t rawValue() const { return raw; }
+
+    explicit constexpr operator double() const { return (double)raw / (double)ONE; }
+    explicit constexpr operator float() const { return (float)raw / (float)ONE; }
+    // Truncates toward zero, like a double -> integer cast
+    explicit constexpr operator int64_t() const { return raw >= 0 ? (raw >> FRAC_BITS) : -((-raw) >> FRAC_BITS); }
+
+    // --- Arithmetic ---
+    friend constexpr Fixed operator+(Fixed a, Fixed b) { return fromRaw(a.raw + b.raw); }
+    friend constexpr Fixed operator-(Fixed a, Fixed b) { return fromRaw(a.raw - b.raw); }
+    friend constexpr Fixed operator-(Fixed a) { return fromRaw(-a.raw); }
+    friend Fixed operator*(Fixed a, Fixed b) { return fromRaw(mulShift(a.raw, b.raw)); }
+    friend Fixed operator/(Fixed a, Fixed b) { return fromRaw(divShift(a.raw, b.raw)); }
+
+    Fixed& operator+=(Fixed o) { raw += o.raw; return *this; }
+    Fixed& operator-=(Fixed o) { raw -= o.raw; return *this; }
+    Fixed& operator*=(Fixed o) { raw = mulShift(raw, o.raw); return *this; }
+    Fixed& operator/=(Fixed o) { raw = divShift(raw, o.raw); return *this; }
+
+    // --- Comparison ---
+    friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+    friend constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+    friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+    friend constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+    friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+    friend constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+private:
+    int64_t raw;
+
+    // (a * b) >> FRAC_BITS
+    static int64_t mulShift(int64_t a, int64_t b) {
+#if defined(__SIZEOF_INT128__) && !defined(ORM_FIXED_PORTABLE_MATH)
+        return (int64_t)(((__int128)a * b) >> FRAC_BITS);
+#else
+        bool negative = (a < 0) != (b < 0);
+        uint64_t ua = (a < 0) ? (0 - (uint64_t)a) : (uint64_t)a;
+        uint64_t ub = (b < 0) ? (0 - (uint64_t)b) : (uint64_t)b;
+
+        // 64x64 -> 128 bit product from four 32x32 -> 64 bit multiplies
+        uint64_t aLo = (uint32_t)ua, aHi = ua >> 32;
+        uint64_t bLo = (uint32_t)ub, bHi = ub >> 32;
+        uint64_t lo = aLo * bLo;
+        uint64_t mid1 = aHi * bLo;
+        uint64_t mid2 = aLo * bHi;
+        uint64_t hi = aHi * bHi;
+
+        uint64_t mid = (lo >> 32) + (uint32_t)mid1 + (uint32_t)mid2;
+        uint64_t productLo = (mid << 32) | (uint32_t)lo;
+        uint64_t productHi = hi + (mid1 >> 32) + (mid2 >> 32) + (mid >> 32);
+
+        uint64_t result = (productLo >> FRAC_BITS) | (productHi << (64 - FRAC_BITS));
+        return negative ? -(int64_t)result : (int64_t)result;
+#endif
+    }
+
+    // (a << FRAC_BITS) / b, saturating on division by zero
+    static int64_t divShift(int64_t a, int64_t b) {
+        if (b == 0) {
+            return (a >= 0) ? INT64_MAX : INT64_MIN;
+        }
+#if defined(__SIZEOF_INT128__) && !defined(ORM_FIXED_PORTABLE_MATH)
+        return (int64_t)(((__int128)a * ONE) / b);
+#else
+        bool negative = (a < 0) != (b < 0);
+        uint64_t ua = (a < 0) ? (0 - (uint64_t)a) : (uint64_t)a;
+        uint64_t ub = (b < 0) ? (0 - (uint64_t)b) : (uint64_t)b;
+
+        // Integer part with one hardware-sized divide, then the fraction bit by bit
+        uint64_t quotient = ua / ub;
+        uint64_t remainder = ua % ub;
+        for (int i = 0; i < FRAC_BITS; i++) {
+            bool carry = (remainder >> 63) != 0;
+            remainder <<= 1;
+            quotient <<= 1;
+            if (carry || remainder >= ub) {
+                remainder -= ub;
+                quotient |= 1;
+            }
+        }
+        return negative ? -(int64_t)quotient : (int64_t)quotient;
+#endif
+    }
+};
+
+/**
+ * @brief Cube root in fixed point.
+ *
+ * Seeds with the single-precision FPU and refines with one Newton step
+ * y' = (2y + x/y^2) / 3, which restores the precision lost in the float seed.
+ */
+static inline Fixed fixedCbrt(Fixed x) {
+    if (x <= Fixed()) {
+        return Fixed();
+    }
+    Fixed y(std::cbrt(static_cast<float>(x)));
+    if (y == Fixed()) {
+        return y;
+    }
+    return (y + y + x / (y * y)) / Fixed(3);
+}
+
+/**
+ * @brief Square root in fixed point, seeded like fixedCbrt and refined
+ * with one Newton step y' = (y + x/y) / 2.
+ */
+static inline Fixed fixedSqrt(Fixed x) {
+    if (x <= Fixed()) {
+        return Fixed();
+    }
+    Fixed y(std::sqrt(static_cast<float>(x)));
+    if (y == Fixed()) {
+        return y;
+    }
+    return (y + x / y) / Fixed(2);
+}
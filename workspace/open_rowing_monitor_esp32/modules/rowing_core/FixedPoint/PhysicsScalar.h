@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <zephyr/kernel.h> // Required to see CONFIG_ macros
+
+#include "FixedPoint.h"
+
+// ----------------------------------------------------------------------
+// Default arithmetic type of the physics engine, selected in Kconfig.
+// RowingEngine, MovingFlankDetector, MovingAverager, RowingSettings and
+// RowingData are templates on it; every type below is instantiated so
+// the host tools can compare them in one build.
+// ----------------------------------------------------------------------
+#if defined(CONFIG_ORM_ENGINE_FIXED_POINT)
+using PhysicsScalar = Fixed;
+#elif defined(CONFIG_ORM_ENGINE_FLOAT)
+using PhysicsScalar = float;
+#else
+using PhysicsScalar = double;
+#endif
+
+// ----------------------------------------------------------------------
+// Helpers that differ per arithmetic type
+// ----------------------------------------------------------------------
+
+template<typename T> constexpr const char *scalarName();
+template<> constexpr const char *scalarName<double>() { return "double"; }
+template<> constexpr const char *scalarName<float>() { return "float"; }
+template<> constexpr const char *scalarName<Fixed>() { return "fixed"; }
+
+#define PHYSICS_SCALAR_NAME scalarName<PhysicsScalar>()
+
+static inline double scalarCbrt(double x) { return std::cbrt(x); }
+static inline float scalarCbrt(float x) { return std::cbrt(x); }
+static inline Fixed scalarCbrt(Fixed x) { return fixedCbrt(x); }
+static inline double scalarSqrt(double x) { return std::sqrt(x); }
+static inline float scalarSqrt(float x) { return std::sqrt(x); }
+static inline Fixed scalarSqrt(Fixed x) { return fixedSqrt(x); }
+
+/**
+ * @brief Converts k_cycle_get_32() counts into seconds.
+ * The clock rate is inverted once, so a conversion is a multiply. The
+ * engine keeps time in cycles and only converts what it reports.
+ */
+template<typename T>
+class CycleClock {
+public:
+    explicit CycleClock(uint32_t cyclesPerSec)
+        : rate(cyclesPerSec), secondsPerCycle(T(1.0 / (double)cyclesPerSec)) {}
+
+    uint32_t cyclesPerSecond() const { return rate; }
+
+    T toSeconds(uint32_t cycles) const { return T(cycles) * secondsPerCycle; }
+    T toSeconds(uint64_t cycles) const { return T(cycles) * secondsPerCycle; }
+
+    uint32_t toCycles(T seconds) const {
+        double cycles = static_cast<double>(seconds) * (double)rate + 0.5;
+        return (cycles > 0.0) ? (uint32_t)cycles : 0;
+    }
+
+private:
+    uint32_t rate;
+    T secondsPerCycle;
+};
+
+// Fixed point: the reciprocal keeps 24 extra bits and the product is
+// taken in two 16-bit halves, so it stays in 64-bit integer arithmetic.
+template<>
+class CycleClock<Fixed> {
+public:
+    explicit CycleClock(uint32_t cyclesPerSec)
+        : rate(cyclesPerSec),
+          reciprocal((((uint64_t)1 << (Fixed::FRAC_BITS + 24)) + cyclesPerSec / 2) / cyclesPerSec) {}
+
+    uint32_t cyclesPerSecond() const { return rate; }
+
+    Fixed toSeconds(uint32_t cycles) const {
+        uint64_t hi = (uint64_t)(cycles >> 16) * reciprocal;
+        uint64_t lo = (uint64_t)(cycles & 0xFFFF) * reciprocal;
+        return Fixed::fromRaw((int64_t)((hi >> 8) + (lo >> 24)));
+    }
+
+    Fixed toSeconds(uint64_t cycles) const {
+        if ((cycles >> 32) == 0) {
+            return toSeconds((uint32_t)cycles);
+        }
+        // Minutes long: whole seconds first, the divide is off the impulse path
+        uint64_t whole = cycles / rate;
+        return Fixed(whole) + toSeconds((uint32_t)(cycles - whole * rate));
+    }
+
+    uint32_t toCycles(Fixed seconds) const {
+        double cycles = static_cast<double>(seconds) * (double)rate + 0.5;
+        return (cycles > 0.0) ? (uint32_t)cycles : 0;
+    }
+
+private:
+    uint32_t rate;
+    uint64_t reciprocal; // 2^(FRAC_BITS + 24) / rate
+};
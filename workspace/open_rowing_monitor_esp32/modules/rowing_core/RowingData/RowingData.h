@@ -1,44 +1,84 @@
 #pragma once
 
+#include <cstdint>
+#include "PhysicsScalar.h"
+
 enum class RowingState {
     IDLE,
     DRIVE,
-    RECOVERY
+    RECOVERY,
+    PAUSED      // No impulse for maximumImpulseTimeBeforePause, clock stopped
+};
+
+// How the last stroke was rowed, and how steady the strokes are. Force is
+// the flywheel torque and length the flywheel angle: the engine does not
+// know the sprocket, so the handle-side values are left to the app.
+template<typename T = PhysicsScalar>
+struct StrokeQualityData {
+    // Last stroke
+    T driveRecoveryRatio{};  // Drive time / recovery time before it
+    T peakTorque{};          // N·m
+    T peakPosition{};        // Where in the drive the peak fell: 0 = catch, 1 = finish
+    T smoothness{};          // 1 = the torque rose and fell once, lower = bumps and jitter
+    T driveLength{};         // Flywheel angle of the drive, radians
+    T strokePower{};         // Drive work / cycle time, watts
+
+    // Consistency over the session (running mean and standard deviation)
+    uint32_t strokeCount = 0;
+    T powerMean{};
+    T powerStdDev{};
+    T driveLengthMean{};
+    T driveLengthStdDev{};
 };
 
+template<typename T = PhysicsScalar>
 struct RowingData {
     // Current State
     RowingState state = RowingState::IDLE;
 
     // Time
-    double totalTime = 0.0;          // Seconds since start
-    double lastStrokeTime = 0.0;     // Duration of the previous cycle
-    double driveDuration = 0.0;      // Duration of current/last drive
-    double recoveryDuration = 0.0;   // Duration of current/last recovery
+    T totalTime{};          // Seconds since start
+    T lastStrokeTime{};     // Duration of the previous cycle
+    T driveDuration{};      // Duration of current/last drive
+    T recoveryDuration{};   // Duration of current/last recovery
 
     // Physics
-    double dragFactor = 0.0;        // Drag Coefficient
+    T dragFactor{};        // Drag Coefficient
 
     // Instantaneous data
-    double distance = 0.0;      // Total Meters
-    double instSpeed = 0.0;     // m/s (Average for the stroke)
-    double instPower = 0.0;     // Watts (Average for the stroke)
+    T distance{};      // Total Meters
+    T instSpeed{};     // m/s (Average for the stroke)
+    T instPower{};     // Watts (Average for the stroke: drive work / cycle time)
+    T drivePower{};    // Watts (Average over the drive only)
+    T strokeEnergy{};  // Joules put in during the last drive
+
+    // Energy (see CONFIG_ORM_HUMAN_EFFICIENCY_PERCENT)
+    T totalWork{};     // Joules put in this session
+    T totalEnergy{};   // kcal burned: the work through the efficiency, plus the basal rate
+    T energyPerHour{}; // kcal/h at the power of the last stroke
 
     // Cumulative Data for Averages
-    double totalSpmSum = 0.0;
-    double totalSpeedSum = 0.0;
-    double totalPowerSum = 0.0;
+    T totalSpmSum{};
+    T totalSpeedSum{};
+    T totalPowerSum{};
     uint32_t strokeSampleCount = 0;     // Number of strokes recorded in session
 
     // Calculated Averages for BLE
-    double avgSpm = 0.0;
-    double avgSpeed = 0.0;
-    double avgPower = 0.0;
+    T avgSpm{};
+    T avgSpeed{};
+    T avgPower{};
+
+    // Rolling aggregates of the stroke history (see StrokeHistory.h)
+    T recentPower{};       // Watts, mean of the last CONFIG_ORM_RECENT_STROKE_COUNT strokes
+    T recentPace{};        // Seconds per 500 m over the same strokes
+    T splitTime{};         // Seconds the last 500 m took
+    T strokesPerMinute{};  // Strokes over the last minute
 
     // Live Data (High Frequency)
-    double instTorque = 0.0;        // For Force Curve
-    double angularAcceleration = 0.0;
-    double spm = 0.0;               // Strokes Per Minute
+    T instTorque{};        // For Force Curve
+    T impulsePower{};      // Watts, torque x angular velocity of the last impulse
+    T angularAcceleration{};
+    T spm{};               // Strokes Per Minute
     int strokeCount = 0;
 
     // Training Session State
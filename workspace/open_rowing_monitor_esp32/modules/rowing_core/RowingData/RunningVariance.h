@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include "PhysicsScalar.h"
+
+/**
+ * @brief Mean and variance of a stream, one value at a time (Welford).
+ * * O(1) per value and no history. Numerically stable: it sums squared
+ * deviations from the running mean, not squares of the values.
+ */
+template<typename T = PhysicsScalar>
+class RunningVariance {
+private:
+    uint32_t n = 0;
+    T mean{};
+    T m2{};     // Sum of squared deviations from the mean
+
+public:
+    void reset() {
+        n = 0;
+        mean = T(0);
+        m2 = T(0);
+    }
+
+    void push(T value) {
+        n++;
+        T delta = value - mean;
+        mean += delta / T(n);
+        m2 += delta * (value - mean);
+    }
+
+    uint32_t count() const { return n; }
+    T getMean() const { return mean; }
+    // Sample variance, 0 until there are two values
+    T variance() const { return (n > 1) ? m2 / T(n - 1) : T(0); }
+    T stdDev() const { return scalarSqrt(variance()); }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+
+/**
+ * @brief Single-writer publication of a plain struct (sequence lock).
+ * * The writer bumps the sequence to odd, copies the value in and bumps it
+ * back to even; it never waits. A reader copies the value out and
+ * retries if the sequence was odd or changed meanwhile, so it always gets
+ * a consistent snapshot without a kernel mutex.
+ * * A reader that preempted the writer in the middle of publish() (the
+ * BLE/main thread outranks the physics thread) sleeps for 1 ms so the
+ * writer can finish, instead of spinning.
+ * * Only ONE thread may call publish() at a time. D must be trivially
+ * copyable (RowingData is).
+ */
+template<typename D>
+class SeqLock {
+private:
+    D value{};
+    atomic_t sequence = ATOMIC_INIT(0);
+    mutable atomic_t retries = ATOMIC_INIT(0); // Reader retries, proves (lack of) contention
+
+public:
+    void publish(const D &data) {
+        atomic_inc(&sequence); // odd: write in progress
+        barrier_dmem_fence_full();
+        value = data;
+        barrier_dmem_fence_full();
+        atomic_inc(&sequence); // even: consistent again
+    }
+
+    D read() const {
+        D copy;
+        while (true) {
+            atomic_val_t before = atomic_get(&sequence);
+            if ((before & 1) == 0) {
+                barrier_dmem_fence_full();
+                copy = value;
+                barrier_dmem_fence_full();
+                if (atomic_get(&sequence) == before) {
+                    return copy;
+                }
+                atomic_inc(&retries);
+            } else {
+                atomic_inc(&retries);
+                k_msleep(1);
+            }
+        }
+    }
+
+    // One attempt of read() that never waits: false if a publish() was in
+    // progress, and out is then not a consistent snapshot
+    bool tryRead(D &out) const {
+        atomic_val_t before = atomic_get(&sequence);
+        if ((before & 1) != 0) {
+            return false;
+        }
+        barrier_dmem_fence_full();
+        out = value;
+        barrier_dmem_fence_full();
+        return atomic_get(&sequence) == before;
+    }
+
+    uint32_t readerRetries() const {
+        return (uint32_t)atomic_get(&retries);
+    }
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include "PhysicsScalar.h"
+
+/**
+ * @brief One completed stroke: the drive and the recovery before it.
+ */
+template<typename T = PhysicsScalar>
+struct StrokeSample {
+    T driveDuration;
+    T recoveryDuration;
+    T distance;     // Meters covered during the stroke
+    T energy;       // Joules put in during the drive
+    T peakTorque;   // Highest flywheel torque of the drive, N·m
+    T dragFactor;   // Drag factor the stroke was computed with
+
+    T cycleTime() const { return driveDuration + recoveryDuration; }
+    T power() const { return energy / cycleTime(); }
+};
+
+/**
+ * @brief The last N strokes, with rolling aggregates kept up to date.
+ * * Each aggregate is a window over the newest strokes. Its sums are
+ * updated as strokes enter and leave, so push() is O(1) amortized (every
+ * stroke leaves every window once) and the getters never scan the ring:
+ * - recent: the newest recentCount strokes (power, pace)
+ * - split: the fewest newest strokes that cover 500 m (split time)
+ * - minute: the fewest newest strokes that cover 60 s (stroke rate)
+ * A window the ring is too short for averages over what it holds.
+ * * Not thread-safe: the engine keeps it under its stroke lock.
+ * cycleTime() of every pushed stroke must be above 0.
+ */
+template<int N, typename T = PhysicsScalar>
+class StrokeHistory {
+private:
+    static_assert(N >= 2, "StrokeHistory needs room for 2 strokes");
+
+    struct Window {
+        uint32_t first;     // Stroke number of the oldest stroke in the window
+        T time;
+        T distance;
+        T power;
+
+        void add(const StrokeSample<T> &sample) {
+            time += sample.cycleTime();
+            distance += sample.distance;
+            power += sample.power();
+        }
+
+        void remove(const StrokeSample<T> &sample) {
+            time -= sample.cycleTime();
+            distance -= sample.distance;
+            power -= sample.power();
+            first++;
+        }
+    };
+
+    StrokeSample<T> samples[N];
+    uint32_t pushed;        // Strokes since reset(); stroke k is at samples[k % N]
+    int recentCount;
+    Window recent;
+    Window split;
+    Window minute;
+
+    const StrokeSample<T> &oldestOf(const Window &window) const { return samples[window.first % N]; }
+    int countOf(const Window &window) const { return (int)(pushed - window.first); }
+
+public:
+    // recentCount is clamped to 1..N
+    explicit StrokeHistory(int recentStrokes = N)
+        : recentCount(recentStrokes < 1 ? 1 : (recentStrokes > N ? N : recentStrokes)) {
+        reset();
+    }
+
+    void reset() {
+        pushed = 0;
+        recent = split = minute = Window{0, T(0), T(0), T(0)};
+    }
+
+    void push(const StrokeSample<T> &sample) {
+        // The stroke about to be overwritten leaves every window still holding it
+        if (pushed >= (uint32_t)N) {
+            uint32_t overwritten = pushed - N;
+            const StrokeSample<T> &old = samples[overwritten % N];
+            if (recent.first == overwritten) recent.remove(old);
+            if (split.first == overwritten) split.remove(old);
+            if (minute.first == overwritten) minute.remove(old);
+        }
+        samples[pushed % N] = sample;
+        pushed++;
+        recent.add(sample);
+        split.add(sample);
+        minute.add(sample);
+
+        while (countOf(recent) > recentCount) {
+            recent.remove(oldestOf(recent));
+        }
+        // Drop the oldest stroke while the rest still covers the span
+        while (countOf(split) > 1 && split.distance - oldestOf(split).distance >= T(500)) {
+            split.remove(oldestOf(split));
+        }
+        while (countOf(minute) > 1 && minute.time - oldestOf(minute).cycleTime() >= T(60)) {
+            minute.remove(oldestOf(minute));
+        }
+    }
+
+    // Strokes held, at most N
+    int size() const { return (pushed < (uint32_t)N) ? (int)pushed : N; }
+
+    // age 0 is the newest stroke, size() - 1 the oldest held
+    const StrokeSample<T> &at(int age) const { return samples[(pushed - 1 - age) % N]; }
+
+    // Mean power of the recent strokes, watts
+    T recentPower() const {
+        int count = countOf(recent);
+        return (count > 0) ? recent.power / T(count) : T(0);
+    }
+
+    // Pace of the recent strokes, seconds per 500 m
+    T recentPace() const {
+        return (recent.distance > T(0)) ? recent.time * T(500) / recent.distance : T(0);
+    }
+
+    // Time the last 500 m took, seconds (scaled from the window's distance)
+    T splitTime() const {
+        return (split.distance > T(0)) ? split.time * T(500) / split.distance : T(0);
+    }
+
+    // Strokes over the last minute
+    T strokesPerMinute() const {
+        return (minute.time > T(0)) ? T(countOf(minute)) * T(60) / minute.time : T(0);
+    }
+};
@@ -2,33 +2,52 @@
 
 #include <zephyr/kernel.h>
 #include <cstdint>
+#include "PhysicsScalar.h"
+
+// Bins of impulseDecimation sensor impulses in 1/steps of a revolution,
+// rounded, at least one
+static constexpr int impulsesPerAnalysisStep(double impulsesPerRevolution, int impulseDecimation, int steps) {
+    double bins = impulsesPerRevolution / ((double)impulseDecimation * (double)steps);
+    return (bins < 1.5) ? 1 : (int)(bins + 0.5);
+}
 
 /**
  * @brief Configuration struct for the Open Rowing Monitor Physics Engine.
  * * This struct maps Zephyr Kconfig values (defined in module/RowingSettings/Kconfig)
- * to usable C++ types (doubles, bools) for the physics engine.
+ * to usable C++ types (T, bools) for the physics engine, where T is the
+ * arithmetic type of the engine instance (PhysicsScalar by default).
  * * It handles the conversion from "scaled integers" (used in Kconfig) to
  * actual floating point units (seconds, kg*m^2, etc).
  */
+template<typename T = PhysicsScalar>
 struct RowingSettings {
+    // Values can change while the firmware runs (see SettingsStore.h)
+    static constexpr bool tunable = true;
+
     // =========================================================
     // 1. Physics Constants
     // =========================================================
 
     // Number of magnets on the flywheel (default: 1)
-    double numOfImpulsesPerRevolution = (double)CONFIG_ORM_IMPULSES_PER_REV;
+    T numOfImpulsesPerRevolution = T((double)CONFIG_ORM_IMPULSES_PER_REV);
+
+    // Sensor impulses binned into one engine impulse (see ImpulseDecimator.h)
+    int impulseDecimation = CONFIG_ORM_IMPULSE_DECIMATION;
+
+    // Resolution of flank detection and drag, whatever the bin size
+    int analysisStepsPerRevolution = CONFIG_ORM_ANALYSIS_STEPS_PER_REV;
 
     // Flywheel Inertia in kg*m^2.
     // Kconfig uses x10000 scaling (e.g., 600 -> 0.06 kg*m^2)
-    double flywheelInertia = (double)CONFIG_ORM_FLYWHEEL_INERTIA_X10000 / 10000.0;
+    T flywheelInertia = T((double)CONFIG_ORM_FLYWHEEL_INERTIA_X10000 / 10000.0);
 
     // Magic Constant for distance calculation.
     // Kconfig uses x10000 scaling (e.g. 28000 -> 2.8)
     // Note: We default to 2.8 (Concept2 standard) if not defined.
     #ifdef CONFIG_ORM_MAGIC_CONSTANT_X10000
-    double magicConstant = (double)CONFIG_ORM_MAGIC_CONSTANT_X10000 / 10000.0;
+    T magicConstant = T((double)CONFIG_ORM_MAGIC_CONSTANT_X10000 / 10000.0);
     #else
-    double magicConstant = 2.8;
+    T magicConstant = T(2.8);
     #endif
 
     // =========================================================
@@ -36,19 +55,19 @@ struct RowingSettings {
     // =========================================================
 
     // Shortest valid time between magnets. Filters switch bounce/noise.
-    double minimumTimeBetweenImpulses = (double)CONFIG_ORM_MIN_TIME_BETWEEN_IMPULSE_X10000 / 10000.0;
+    T minimumTimeBetweenImpulses = T((double)CONFIG_ORM_MIN_TIME_BETWEEN_IMPULSE_X10000 / 10000.0);
 
     // Longest valid time between magnets. Slower than this = Pause/Stop.
-    double maximumTimeBetweenImpulses = (double)CONFIG_ORM_MAX_TIME_BETWEEN_IMPULSE_X10000 / 10000.0;
+    T maximumTimeBetweenImpulses = T((double)CONFIG_ORM_MAX_TIME_BETWEEN_IMPULSE_X10000 / 10000.0);
 
     // Minimum duration required for a valid Drive Phase.
-    double minimumDriveTime = (double)CONFIG_ORM_MIN_DRIVE_TIME_X10000 / 10000.0;
+    T minimumDriveTime = T((double)CONFIG_ORM_MIN_DRIVE_TIME_X10000 / 10000.0);
 
     // Minimum duration required for a valid Recovery Phase.
-    double minimumRecoveryTime = (double)CONFIG_ORM_MIN_RECOVERY_TIME_X10000 / 10000.0;
+    T minimumRecoveryTime = T((double)CONFIG_ORM_MIN_RECOVERY_TIME_X10000 / 10000.0);
 
     // Max time allowed for a single impulse before assuming the user paused the workout.
-    double maximumImpulseTimeBeforePause = (double)CONFIG_ORM_MAX_IMPULSE_TIME_BEFORE_PAUSE_X10000 / 10000.0;
+    T maximumImpulseTimeBeforePause = T((double)CONFIG_ORM_MAX_IMPULSE_TIME_BEFORE_PAUSE_X10000 / 10000.0);
 
     // =========================================================
     // 3. Flank Detection & Noise Filters
@@ -64,13 +83,13 @@ struct RowingSettings {
     int numberOfErrorsAllowed = CONFIG_ORM_NUM_OF_ERRORS_ALLOWED;
 
     // Max allowed acceleration % per impulse (e.g. 0.25 = 25%).
-    double maximumDownwardChange = (double)CONFIG_ORM_MAXIMUM_DOWNWARD_CHANGE_X10000 / 10000.0;
+    T maximumDownwardChange = T((double)CONFIG_ORM_MAXIMUM_DOWNWARD_CHANGE_X10000 / 10000.0);
 
     // Max allowed deceleration % per impulse (e.g. 1.75 = 175%).
-    double maximumUpwardChange = (double)CONFIG_ORM_MAXIMUM_UPWARD_CHANGE_X10000 / 10000.0;
+    T maximumUpwardChange = T((double)CONFIG_ORM_MAXIMUM_UPWARD_CHANGE_X10000 / 10000.0);
 
     // Natural deceleration of flywheel (if using pure physics detection).
-    double naturalDeceleration = (double)CONFIG_ORM_NATURAL_DECELARATION_X10000 / 10000.0;
+    T naturalDeceleration = T((double)CONFIG_ORM_NATURAL_DECELARATION_X10000 / 10000.0);
 
     // =========================================================
     // 4. Drag Factor Logic
@@ -79,7 +98,7 @@ struct RowingSettings {
     // Base Drag Factor.
     // Note: JS engine divides by 1,000,000.
     // If Kconfig is 1500, this becomes 0.0015.
-    double dragFactor = (double)CONFIG_ORM_DRAG_FACTOR / 1000000.0;
+    T dragFactor = T((double)CONFIG_ORM_DRAG_FACTOR / 1000000.0);
 
     // Check if Auto-Adjust feature is enabled in Kconfig
     bool autoAdjustDragFactor = IS_ENABLED(CONFIG_ORM_AUTO_ADJUST_DRAG_FACTOR);
@@ -89,10 +108,156 @@ struct RowingSettings {
     #ifdef CONFIG_ORM_AUTO_ADJUST_DRAG_FACTOR
         int dampingConstantSmoothing = CONFIG_ORM_DAMPING_CONSTANT_SMOOTING;
         // Max change allowed in Drag Factor (e.g. 0.1 = 10%)
-        double dampingConstantMaxChange = (double)CONFIG_ORM_DAMPING_CONSTANT_MAX_CHANGE_X10000 / 10000.0;
+        T dampingConstantMaxChange = T((double)CONFIG_ORM_DAMPING_CONSTANT_MAX_CHANGE_X10000 / 10000.0);
     #else
         // Dummy defaults to prevent compilation errors if referenced
         int dampingConstantSmoothing = 1;
-        double dampingConstantMaxChange = 0.0;
+        T dampingConstantMaxChange = T(0.0);
+    #endif
+
+    // =========================================================
+    // 5. Energy Model
+    // =========================================================
+
+    // Share of the burned energy that reaches the flywheel (e.g. 0.25 = 25%).
+    T humanEfficiency = T((double)CONFIG_ORM_HUMAN_EFFICIENCY_PERCENT / 100.0);
+
+    // kcal per hour burned on top of the work.
+    T basalEnergyRate = T((double)CONFIG_ORM_BASAL_ENERGY_KCAL_PER_HOUR);
+
+    // =========================================================
+    // 6. Derived Values
+    // =========================================================
+    // Precomputed from the fields above so the engine does not redo the
+    // division / cube root per impulse. Call updateDerived() after
+    // changing any field at runtime.
+
+    // Flywheel angle (rad) between two engine impulses (one bin of sensor impulses).
+    T angularDisplacementPerImpulse = T(2.0 * 3.14159265359 * CONFIG_ORM_IMPULSE_DECIMATION / (double)CONFIG_ORM_IMPULSES_PER_REV);
+
+    // Engine impulses in one analysis step, at least one
+    int impulsesPerStep = impulsesPerAnalysisStep((double)CONFIG_ORM_IMPULSES_PER_REV, CONFIG_ORM_IMPULSE_DECIMATION,
+                                                  CONFIG_ORM_ANALYSIS_STEPS_PER_REV);
+
+    // What the flank detectors see: angle (rad) and valid time range of one
+    // analysis step. The impulse values when a step is one impulse.
+    T angularDisplacementPerStep = T(2.0 * 3.14159265359 * CONFIG_ORM_IMPULSE_DECIMATION * impulsesPerStep / (double)CONFIG_ORM_IMPULSES_PER_REV);
+    T minimumTimeBetweenSteps = T((double)CONFIG_ORM_MIN_TIME_BETWEEN_IMPULSE_X10000 / 10000.0 * impulsesPerStep);
+    T maximumTimeBetweenSteps = T((double)CONFIG_ORM_MAX_TIME_BETWEEN_IMPULSE_X10000 / 10000.0 * impulsesPerStep);
+
+    // Plausible linear displacement of a stroke for the configured drag factor,
+    // used to seed the recovery phase before the first stroke.
+    T plausibleDisplacement = T(8) / scalarCbrt(dragFactor / magicConstant);
+
+    // Joules of flywheel work per kcal burned (4184 J/kcal through the efficiency)
+    T joulesPerKcal = T(4184) * humanEfficiency;
+
+    // Same arithmetic as the initializers above, so republishing unchanged
+    // settings gives bit-identical values
+    void updateDerived() {
+        angularDisplacementPerImpulse = T(2.0 * 3.14159265359 * impulseDecimation / static_cast<double>(numOfImpulsesPerRevolution));
+        impulsesPerStep = impulsesPerAnalysisStep(static_cast<double>(numOfImpulsesPerRevolution), impulseDecimation,
+                                                  analysisStepsPerRevolution);
+        angularDisplacementPerStep = T(2.0 * 3.14159265359 * impulseDecimation * impulsesPerStep / static_cast<double>(numOfImpulsesPerRevolution));
+        minimumTimeBetweenSteps = T(static_cast<double>(minimumTimeBetweenImpulses) * impulsesPerStep);
+        maximumTimeBetweenSteps = T(static_cast<double>(maximumTimeBetweenImpulses) * impulsesPerStep);
+        plausibleDisplacement = T(8) / scalarCbrt(dragFactor / magicConstant);
+        joulesPerKcal = T(4184) * humanEfficiency;
+    }
+};
+
+// ----------------------------------------------------------------------
+// Compile-time settings
+// ----------------------------------------------------------------------
+
+// Newton iteration, std::cbrt is not constexpr
+static constexpr double constexprCbrt(double x) {
+    if (x <= 0.0) return 0.0;
+    double y = (x > 1.0) ? x : 1.0;
+    for (int i = 0; i < 200; i++) {
+        double next = (2.0 * y + x / (y * y)) / 3.0;
+        if (next == y) break;
+        y = next;
+    }
+    return y;
+}
+
+/**
+ * @brief Kconfig values as constant expressions.
+ * * Same member names as RowingSettings, but every value is a static
+ * constexpr, so an engine instantiated with it folds loop bounds,
+ * thresholds and derived values into the code instead of loading them
+ * per impulse. The values cannot change at runtime.
+ */
+template<typename T = PhysicsScalar>
+struct StaticRowingSettings {
+    static constexpr bool tunable = false;
+
+    // 1. Physics Constants
+    static constexpr T numOfImpulsesPerRevolution = T((double)CONFIG_ORM_IMPULSES_PER_REV);
+    static constexpr int impulseDecimation = CONFIG_ORM_IMPULSE_DECIMATION;
+    static constexpr int analysisStepsPerRevolution = CONFIG_ORM_ANALYSIS_STEPS_PER_REV;
+    static constexpr T flywheelInertia = T((double)CONFIG_ORM_FLYWHEEL_INERTIA_X10000 / 10000.0);
+    #ifdef CONFIG_ORM_MAGIC_CONSTANT_X10000
+    static constexpr double magicConstantValue = (double)CONFIG_ORM_MAGIC_CONSTANT_X10000 / 10000.0;
+    #else
+    static constexpr double magicConstantValue = 2.8;
     #endif
+    static constexpr T magicConstant = T(magicConstantValue);
+
+    // 2. Timing & Validation Limits (Seconds)
+    static constexpr T minimumTimeBetweenImpulses = T((double)CONFIG_ORM_MIN_TIME_BETWEEN_IMPULSE_X10000 / 10000.0);
+    static constexpr T maximumTimeBetweenImpulses = T((double)CONFIG_ORM_MAX_TIME_BETWEEN_IMPULSE_X10000 / 10000.0);
+    static constexpr T minimumDriveTime = T((double)CONFIG_ORM_MIN_DRIVE_TIME_X10000 / 10000.0);
+    static constexpr T minimumRecoveryTime = T((double)CONFIG_ORM_MIN_RECOVERY_TIME_X10000 / 10000.0);
+    static constexpr T maximumImpulseTimeBeforePause = T((double)CONFIG_ORM_MAX_IMPULSE_TIME_BEFORE_PAUSE_X10000 / 10000.0);
+
+    // 3. Flank Detection & Noise Filters
+    static constexpr int smoothing = CONFIG_ORM_SMOOTHING;
+    static constexpr int flankLength = CONFIG_ORM_FLANK_LENGTH;
+    static constexpr int numberOfErrorsAllowed = CONFIG_ORM_NUM_OF_ERRORS_ALLOWED;
+    static constexpr T maximumDownwardChange = T((double)CONFIG_ORM_MAXIMUM_DOWNWARD_CHANGE_X10000 / 10000.0);
+    static constexpr T maximumUpwardChange = T((double)CONFIG_ORM_MAXIMUM_UPWARD_CHANGE_X10000 / 10000.0);
+    static constexpr T naturalDeceleration = T((double)CONFIG_ORM_NATURAL_DECELARATION_X10000 / 10000.0);
+
+    // 4. Drag Factor Logic
+    static constexpr double dragFactorValue = (double)CONFIG_ORM_DRAG_FACTOR / 1000000.0;
+    static constexpr T dragFactor = T(dragFactorValue);
+    static constexpr bool autoAdjustDragFactor = IS_ENABLED(CONFIG_ORM_AUTO_ADJUST_DRAG_FACTOR);
+    #ifdef CONFIG_ORM_AUTO_ADJUST_DRAG_FACTOR
+        static constexpr int dampingConstantSmoothing = CONFIG_ORM_DAMPING_CONSTANT_SMOOTING;
+        static constexpr T dampingConstantMaxChange = T((double)CONFIG_ORM_DAMPING_CONSTANT_MAX_CHANGE_X10000 / 10000.0);
+    #else
+        static constexpr int dampingConstantSmoothing = 1;
+        static constexpr T dampingConstantMaxChange = T(0.0);
+    #endif
+
+    // 5. Energy Model
+    static constexpr T humanEfficiency = T((double)CONFIG_ORM_HUMAN_EFFICIENCY_PERCENT / 100.0);
+    static constexpr T basalEnergyRate = T((double)CONFIG_ORM_BASAL_ENERGY_KCAL_PER_HOUR);
+
+    // 6. Derived Values
+    static constexpr T angularDisplacementPerImpulse = T(2.0 * 3.14159265359 * CONFIG_ORM_IMPULSE_DECIMATION / (double)CONFIG_ORM_IMPULSES_PER_REV);
+    static constexpr int impulsesPerStep = impulsesPerAnalysisStep((double)CONFIG_ORM_IMPULSES_PER_REV,
+                                                                   CONFIG_ORM_IMPULSE_DECIMATION,
+                                                                   CONFIG_ORM_ANALYSIS_STEPS_PER_REV);
+    static constexpr T angularDisplacementPerStep = T(2.0 * 3.14159265359 * CONFIG_ORM_IMPULSE_DECIMATION * impulsesPerStep / (double)CONFIG_ORM_IMPULSES_PER_REV);
+    static constexpr T minimumTimeBetweenSteps = T((double)CONFIG_ORM_MIN_TIME_BETWEEN_IMPULSE_X10000 / 10000.0 * impulsesPerStep);
+    static constexpr T maximumTimeBetweenSteps = T((double)CONFIG_ORM_MAX_TIME_BETWEEN_IMPULSE_X10000 / 10000.0 * impulsesPerStep);
+    static constexpr T plausibleDisplacement = T(8.0 / constexprCbrt(dragFactorValue / magicConstantValue));
+    static constexpr T joulesPerKcal = T(4184.0 * CONFIG_ORM_HUMAN_EFFICIENCY_PERCENT / 100.0);
+
+    static_assert(CONFIG_ORM_IMPULSES_PER_REV > 0, "CONFIG_ORM_IMPULSES_PER_REV must be positive");
+    static_assert(CONFIG_ORM_IMPULSES_PER_REV % CONFIG_ORM_IMPULSE_DECIMATION == 0,
+                  "CONFIG_ORM_IMPULSE_DECIMATION must divide CONFIG_ORM_IMPULSES_PER_REV");
+    static_assert(CONFIG_ORM_FLANK_LENGTH >= 1, "CONFIG_ORM_FLANK_LENGTH must be at least 1");
 };
+
+// Settings type the firmware instantiates the engine with (see CONFIG_ORM_SETTINGS_COMPILE_TIME)
+#ifdef CONFIG_ORM_SETTINGS_COMPILE_TIME
+template<typename T = PhysicsScalar>
+using DefaultRowingSettings = StaticRowingSettings<T>;
+#else
+template<typename T = PhysicsScalar>
+using DefaultRowingSettings = RowingSettings<T>;
+#endif
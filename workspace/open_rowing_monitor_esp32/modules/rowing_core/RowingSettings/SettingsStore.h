@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "RowingSettings.h"
+#include "SeqLock.h"
+
+/**
+ * @brief Versioned settings snapshots, shared by every engine.
+ * * update() copies the current snapshot, lets the caller change the
+ * copy, recomputes the derived values and publishes the result as the
+ * next version. A published snapshot is never modified, only replaced.
+ * * Readers (the physics thread, once per impulse) compare getVersion()
+ * with the version they hold, one atomic load, and only copy the new
+ * snapshot out when it changed. The copy goes through a SeqLock, so a
+ * reader never takes a lock: if it catches a writer mid-publish it keeps
+ * its old copy and tries again at the next impulse. The engine keeps its
+ * own copy until the next version, so nothing has to be reclaimed.
+ * * Writers (shell, BLE) are serialized by a mutex. S must be tunable
+ * (RowingSettings, not StaticRowingSettings).
+ */
+template<typename S>
+class SettingsStore {
+    static_assert(S::tunable, "StaticRowingSettings are compiled in, they cannot be updated");
+
+private:
+    SeqLock<S> snapshot;
+    atomic_t version = ATOMIC_INIT(1);
+    mutable k_mutex updateLock;
+
+public:
+    explicit SettingsStore(const S &initial) {
+        k_mutex_init(&updateLock);
+        snapshot.publish(initial);
+    }
+
+    uint32_t getVersion() const { return (uint32_t)atomic_get(&version); }
+
+    // Copies the current snapshot out without waiting, false if a writer was
+    // publishing it (try again later). snapshotVersion is that of the copy, or
+    // older: then getVersion() differs and the snapshot is simply read again.
+    bool tryRead(S &out, uint32_t &snapshotVersion) const {
+        snapshotVersion = getVersion();
+        return snapshot.tryRead(out);
+    }
+
+    // Blocking copy, for everything off the physics thread
+    S read() const { return snapshot.read(); }
+
+    // change(S &) edits a copy of the current snapshot and returns false to
+    // drop it. Returns the published version, 0 if nothing was published.
+    template<typename F>
+    uint32_t update(F change) {
+        k_mutex_lock(&updateLock, K_FOREVER);
+        S next = snapshot.read();
+        if (!change(next)) {
+            k_mutex_unlock(&updateLock);
+            return 0;
+        }
+        next.updateDerived();
+        snapshot.publish(next);
+        uint32_t published = (uint32_t)atomic_inc(&version) + 1;
+        k_mutex_unlock(&updateLock);
+        return published;
+    }
+};
+
+// The store the firmware shares between the engines, shell and BLE
+using RowingSettingsStore = SettingsStore<RowingSettings<>>;
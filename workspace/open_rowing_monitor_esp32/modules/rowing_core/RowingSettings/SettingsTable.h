@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "RowingSettings.h"
+
+/**
+ * @brief The runtime-tunable settings by name, in Kconfig units.
+ * * Every entry is named after its Kconfig symbol without CONFIG_ORM_, in
+ * lower case, and takes the same scaled integer (flywheel_inertia_x10000
+ * = 19 is 0.0019 kg*m^2). The id is the position in the table; the BLE
+ * settings characteristic writes it, so entries are only ever appended.
+ * * Window lengths can shrink and grow back, but not past the Kconfig
+ * value their buffers were sized with.
+ */
+enum class SettingId : uint8_t {
+    IMPULSES_PER_REV,
+    FLYWHEEL_INERTIA,
+    MAGIC_CONSTANT,
+    MIN_TIME_BETWEEN_IMPULSE,
+    MAX_TIME_BETWEEN_IMPULSE,
+    MAX_IMPULSE_TIME_BEFORE_PAUSE,
+    MIN_DRIVE_TIME,
+    MIN_RECOVERY_TIME,
+    SMOOTHING,
+    FLANK_LENGTH,
+    NUM_OF_ERRORS_ALLOWED,
+    MAXIMUM_DOWNWARD_CHANGE,
+    MAXIMUM_UPWARD_CHANGE,
+    NATURAL_DECELERATION,
+    DRAG_FACTOR,
+    AUTO_ADJUST_DRAG_FACTOR,
+    DAMPING_CONSTANT_SMOOTHING,
+    DAMPING_CONSTANT_MAX_CHANGE,
+    HUMAN_EFFICIENCY,
+    BASAL_ENERGY_RATE,
+    COUNT
+};
+
+struct SettingInfo {
+    const char *name;
+    int32_t scale;      // Kconfig units per unit of the field (1 for counts and flags)
+    int32_t minimum;
+    int32_t maximum;
+};
+
+// Capacity of the drag factor median (DRAG_MEDIAN_SIZE in RowingEngine.h)
+#ifdef CONFIG_ORM_AUTO_ADJUST_DRAG_FACTOR
+    #define SETTINGS_DRAG_SMOOTHING_MAX CONFIG_ORM_DAMPING_CONSTANT_SMOOTING
+#else
+    #define SETTINGS_DRAG_SMOOTHING_MAX 1
+#endif
+
+inline constexpr SettingInfo settingInfo[] = {
+    {"impulses_per_rev",                    1,       1,         10000},
+    {"flywheel_inertia_x10000",             10000,   1,         10000000},
+    {"magic_constant_x10000",               10000,   1,         1000000},
+    {"min_time_between_impulse_x10000",     10000,   1,         10000},
+    {"max_time_between_impulse_x10000",     10000,   1,         100000},
+    {"max_impulse_time_before_pause_x10000", 10000,  1000,      600000},
+    {"min_drive_time_x10000",               10000,   0,         100000},
+    {"min_recovery_time_x10000",            10000,   0,         100000},
+    {"smoothing",                           1,       1,         CONFIG_ORM_SMOOTHING},
+    {"flank_length",                        1,       1,         CONFIG_ORM_FLANK_LENGTH},
+    {"num_of_errors_allowed",               1,       0,         CONFIG_ORM_FLANK_LENGTH},
+    {"maximum_downward_change_x10000",      10000,   0,         10000},
+    {"maximum_upward_change_x10000",        10000,   10000,     100000},
+    {"natural_decelaration_x10000",         10000,   -10000000, 10000000},
+    {"drag_factor",                         1000000, 1,         10000000},
+    {"auto_adjust_drag_factor",             1,       0,         1},
+    {"damping_constant_smooting",           1,       1,         SETTINGS_DRAG_SMOOTHING_MAX},
+    {"damping_constant_max_change_x10000",  10000,   0,         10000},
+    {"human_efficiency_percent",            100,     5,         100},
+    {"basal_energy_kcal_per_hour",          1,       0,         1000},
+};
+static_assert(ARRAY_SIZE(settingInfo) == (size_t)SettingId::COUNT, "settingInfo must list every SettingId");
+
+// SettingId::COUNT if there is no setting of that name
+inline SettingId findSetting(const char *name) {
+    for (int i = 0; i < (int)SettingId::COUNT; i++) {
+        if (strcmp(settingInfo[i].name, name) == 0) {
+            return (SettingId)i;
+        }
+    }
+    return SettingId::COUNT;
+}
+
+// Calls visit(field) with the member behind id (T, int or bool)
+template<typename R, typename F>
+void visitSetting(R &settings, SettingId id, F &&visit) {
+    switch (id) {
+        case SettingId::IMPULSES_PER_REV:               visit(settings.numOfImpulsesPerRevolution); break;
+        case SettingId::FLYWHEEL_INERTIA:               visit(settings.flywheelInertia); break;
+        case SettingId::MAGIC_CONSTANT:                 visit(settings.magicConstant); break;
+        case SettingId::MIN_TIME_BETWEEN_IMPULSE:       visit(settings.minimumTimeBetweenImpulses); break;
+        case SettingId::MAX_TIME_BETWEEN_IMPULSE:       visit(settings.maximumTimeBetweenImpulses); break;
+        case SettingId::MAX_IMPULSE_TIME_BEFORE_PAUSE:  visit(settings.maximumImpulseTimeBeforePause); break;
+        case SettingId::MIN_DRIVE_TIME:                 visit(settings.minimumDriveTime); break;
+        case SettingId::MIN_RECOVERY_TIME:              visit(settings.minimumRecoveryTime); break;
+        case SettingId::SMOOTHING:                      visit(settings.smoothing); break;
+        case SettingId::FLANK_LENGTH:                   visit(settings.flankLength); break;
+        case SettingId::NUM_OF_ERRORS_ALLOWED:          visit(settings.numberOfErrorsAllowed); break;
+        case SettingId::MAXIMUM_DOWNWARD_CHANGE:        visit(settings.maximumDownwardChange); break;
+        case SettingId::MAXIMUM_UPWARD_CHANGE:          visit(settings.maximumUpwardChange); break;
+        case SettingId::NATURAL_DECELERATION:           visit(settings.naturalDeceleration); break;
+        case SettingId::DRAG_FACTOR:                    visit(settings.dragFactor); break;
+        case SettingId::AUTO_ADJUST_DRAG_FACTOR:        visit(settings.autoAdjustDragFactor); break;
+        case SettingId::DAMPING_CONSTANT_SMOOTHING:     visit(settings.dampingConstantSmoothing); break;
+        case SettingId::DAMPING_CONSTANT_MAX_CHANGE:    visit(settings.dampingConstantMaxChange); break;
+        case SettingId::HUMAN_EFFICIENCY:               visit(settings.humanEfficiency); break;
+        case SettingId::BASAL_ENERGY_RATE:              visit(settings.basalEnergyRate); break;
+        default: break;
+    }
+}
+
+// Value of a setting in Kconfig units
+template<typename T>
+int32_t getSetting(const RowingSettings<T> &settings, SettingId id) {
+    if (id >= SettingId::COUNT) return 0;
+    const int32_t scale = settingInfo[(int)id].scale;
+    int32_t value = 0;
+    visitSetting(settings, id, [&](const auto &field) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(field)>, T>) {
+            value = (int32_t)std::lround(static_cast<double>(field) * (double)scale);
+        } else {
+            value = (int32_t)field;
+        }
+    });
+    return value;
+}
+
+// Sets a setting from Kconfig units. Out of range, or a combination the
+// engine cannot run with, returns false and leaves settings untouched.
+// Derived values are left to updateDerived() (SettingsStore::update() calls it).
+template<typename T>
+bool setSetting(RowingSettings<T> &settings, SettingId id, int32_t value) {
+    if (id >= SettingId::COUNT) return false;
+    const SettingInfo &info = settingInfo[(int)id];
+    if (value < info.minimum || value > info.maximum) return false;
+
+    RowingSettings<T> next = settings;
+    visitSetting(next, id, [&](auto &field) {
+        using F = std::decay_t<decltype(field)>;
+        if constexpr (std::is_same_v<F, bool>) {
+            field = (value != 0);
+        } else if constexpr (std::is_same_v<F, int>) {
+            field = value;
+        } else {
+            field = T((double)value / (double)info.scale);
+        }
+    });
+
+    if (getSetting(next, SettingId::IMPULSES_PER_REV) % next.impulseDecimation != 0) return false;
+    if (!(next.minimumTimeBetweenImpulses < next.maximumTimeBetweenImpulses)) return false;
+    settings = next;
+    return true;
+}
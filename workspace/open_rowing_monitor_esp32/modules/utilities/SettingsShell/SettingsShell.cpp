@@ -0,0 +1,69 @@
+#include "SettingsShell.h"
+#include <cstdlib>
+#include <zephyr/shell/shell.h>
+#include <zephyr/logging/log.h>
+
+#include "SettingsTable.h"
+
+LOG_MODULE_REGISTER(SettingsShell, LOG_LEVEL_INF);
+
+// Shell handlers are plain functions, they reach the store through here
+static RowingSettingsStore *settingsStore = nullptr;
+
+void SettingsShell::init(RowingSettingsStore &store) {
+    settingsStore = &store;
+    LOG_INF("Settings shell ready: orm settings, orm set <name> <value>");
+}
+
+static int cmdSettings(const struct shell *sh, size_t argc, char **argv) {
+    if (settingsStore == nullptr) {
+        shell_error(sh, "Settings are not initialized");
+        return -ENODEV;
+    }
+    RowingSettings<> settings = settingsStore->read();
+    shell_print(sh, "Settings version %u, Kconfig units:", settingsStore->getVersion());
+    for (int i = 0; i < (int)SettingId::COUNT; i++) {
+        const SettingInfo &info = settingInfo[i];
+        shell_print(sh, "%2d %-38s %10d  [%d..%d]", i, info.name, getSetting(settings, (SettingId)i),
+                    info.minimum, info.maximum);
+    }
+    return 0;
+}
+
+static int cmdSet(const struct shell *sh, size_t argc, char **argv) {
+    if (settingsStore == nullptr) {
+        shell_error(sh, "Settings are not initialized");
+        return -ENODEV;
+    }
+    SettingId id = findSetting(argv[1]);
+    if (id == SettingId::COUNT) {
+        shell_error(sh, "Unknown setting %s, see orm settings", argv[1]);
+        return -EINVAL;
+    }
+    char *end;
+    long value = strtol(argv[2], &end, 10);
+    if (*end != '\0') {
+        shell_error(sh, "%s is not an integer", argv[2]);
+        return -EINVAL;
+    }
+
+    uint32_t version = settingsStore->update([&](RowingSettings<> &settings) {
+        return setSetting(settings, id, (int32_t)value);
+    });
+    if (version == 0) {
+        const SettingInfo &info = settingInfo[(int)id];
+        shell_error(sh, "%s = %ld rejected (range %d..%d, min time below max time, "
+                    "impulses a multiple of the decimation)", info.name, value, info.minimum, info.maximum);
+        return -EINVAL;
+    }
+    shell_print(sh, "%s = %ld, version %u (taken at the next impulse)", argv[1], value, version);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(ormCommands,
+    SHELL_CMD(settings, NULL, "List the runtime settings (Kconfig units)", cmdSettings),
+    SHELL_CMD_ARG(set, NULL, "<name> <value>: change one setting (Kconfig units)", cmdSet, 3, 0),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(orm, &ormCommands, "Open Rowing Monitor", NULL);
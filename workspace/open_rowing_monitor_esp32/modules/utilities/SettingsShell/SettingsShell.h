@@ -0,0 +1,17 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include "SettingsStore.h"
+
+/**
+ * @brief "orm" shell commands on the runtime settings (CONFIG_ORM_SETTINGS_SHELL)
+ *
+ * orm settings            lists every setting of SettingsTable.h, Kconfig units
+ * orm set <name> <value>  publishes a new version with one setting changed
+ *
+ * The engines following the store take the new version at their next impulse.
+ */
+class SettingsShell {
+public:
+    void init(RowingSettingsStore &store);
+};
@@ -0,0 +1,88 @@
+#include "WarmStart.h"
+#include <cstdlib>
+#include <zephyr/settings/settings.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(WarmStart, LOG_LEVEL_INF);
+
+#define WARM_START_SUBTREE "orm/learned"
+
+// The work handler and the load callback are plain functions, they reach the engines through here
+static RowingEngine<> *rowerEngines = nullptr;
+static LearnedState savedState[CONFIG_ORM_ROWER_COUNT]; // What the flash holds, per rower
+static struct k_work_delayable saveWork;
+
+// One saved rower, key is what follows WARM_START_SUBTREE "/"
+static int loadRower(const char *key, size_t len, settings_read_cb read_cb, void *cb_arg, void *param) {
+    ARG_UNUSED(param);
+    char *end;
+    long rower = (key != nullptr) ? strtol(key, &end, 10) : -1;
+    if (rower < 0 || rower >= CONFIG_ORM_ROWER_COUNT || *end != '\0' || len != sizeof(LearnedState)) {
+        LOG_WRN("Ignoring %s/%s (%u bytes)", WARM_START_SUBTREE, key ? key : "", (unsigned)len);
+        return 0;
+    }
+
+    LearnedState state;
+    if (read_cb(cb_arg, &state, sizeof(state)) != (ssize_t)sizeof(state)) {
+        LOG_ERR("Rower %ld: could not read the saved state", rower);
+        return 0;
+    }
+    if (!rowerEngines[rower].restoreLearnedState(state)) {
+        LOG_INF("Rower %ld: saved drag factor is from another calibration, starting from Kconfig", rower);
+    } else {
+        LOG_INF("Rower %ld: drag factor %.3f x1e6 restored", rower, state.dragFactor * 1e6);
+    }
+    return 0;
+}
+
+// Every rower in one pass, only the ones that changed enough are written
+static void savePass(struct k_work *work) {
+    ARG_UNUSED(work);
+    int written = 0;
+    for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+        LearnedState now = rowerEngines[i].getLearnedState();
+        if (!learnedStateChanged(savedState[i], now, CONFIG_ORM_WARM_START_MIN_CHANGE_PERMILLE / 1000.0)) {
+            continue;
+        }
+        char key[24];
+        snprintk(key, sizeof(key), WARM_START_SUBTREE "/%d", i);
+        int err = settings_save_one(key, &now, sizeof(now));
+        if (err != 0) {
+            LOG_ERR("Rower %d: saving the drag factor failed (%d)", i, err);
+            continue;
+        }
+        savedState[i] = now;
+        written++;
+    }
+    if (written > 0) {
+        LOG_INF("Saved the drag factor of %d rower(s)", written);
+    }
+    k_work_schedule(&saveWork, K_SECONDS(CONFIG_ORM_WARM_START_SAVE_INTERVAL_S));
+}
+
+int WarmStart::init(RowingEngine<> (&engines)[CONFIG_ORM_ROWER_COUNT]) {
+    rowerEngines = engines;
+    k_work_init_delayable(&saveWork, savePass);
+
+    int err = settings_subsys_init();
+    if (err != 0) {
+        LOG_ERR("Settings storage unavailable (%d), no warm start", err);
+        return err;
+    }
+    err = settings_load_subtree_direct(WARM_START_SUBTREE, loadRower, nullptr);
+    if (err != 0) {
+        LOG_WRN("Loading the saved drag factors failed (%d)", err);
+    }
+
+    // Restored or not, this is the value to compare the next passes with
+    for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+        savedState[i] = engines[i].getLearnedState();
+    }
+    k_work_schedule(&saveWork, K_SECONDS(CONFIG_ORM_WARM_START_SAVE_INTERVAL_S));
+    LOG_INF("Warm start ready, drag factor checked every %d s", CONFIG_ORM_WARM_START_SAVE_INTERVAL_S);
+    return 0;
+}
+
+void WarmStart::sessionEnded() {
+    k_work_reschedule(&saveWork, K_NO_WAIT);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include "RowingEngine.h"
+
+/**
+ * @brief Keeps the learned drag factor of every rower across reboots (CONFIG_ORM_WARM_START)
+ *
+ * Each rower's LearnedState is stored through the Zephyr settings
+ * subsystem under "orm/learned/<rower>". init() restores them into the
+ * engines, before the first session. Then a pass on the system work queue
+ * checks every rower each CONFIG_ORM_WARM_START_SAVE_INTERVAL_S seconds
+ * and writes only the rowers whose drag factor moved by more than
+ * CONFIG_ORM_WARM_START_MIN_CHANGE_PERMILLE since their last write, so a
+ * settled drag factor costs no flash wear. sessionEnded() runs the pass now.
+ */
+class WarmStart {
+public:
+    int init(RowingEngine<> (&engines)[CONFIG_ORM_ROWER_COUNT]);
+    void sessionEnded();
+};
@@ -1,6 +1,7 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/sys_heap.h>
+#include <zephyr/sys/util.h>
 
 // Module Headers
 #include "RowingSettings.h"
@@ -16,12 +17,23 @@
 #ifdef CONFIG_SYSM_ENABLE_MONITORING
 #include "SystemMonitor.h"
 #endif
+#ifdef CONFIG_ORM_SETTINGS_SHELL
+#include "SettingsShell.h"
+#endif
+#ifdef CONFIG_ORM_SETTINGS_BLE
+#include "SettingsService.h"
+#endif
+#ifdef CONFIG_ORM_WARM_START
+#include "WarmStart.h"
+#endif
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
 K_EVENT_DEFINE(mainLoopEvent);
-#define BLE_CONNECTED_EVENT     BIT(0)
-#define BLE_DISCONNECTED_EVENT  BIT(1)
+
+// One of each per rower (CONFIG_ORM_ROWER_COUNT), built in place
+#define ROWER_ENGINE(i, _) RowingEngine<>(settings)
+#define ROWER_BRIDGE(i, _) RowerBridge(engines[i], ftmsService, bleManager, i)
 
 void printStartupBanner() {
     LOG_INF("╔════════════════════════════════════════════╗");
@@ -65,14 +77,26 @@ int main(void)
 
     LOG_INF("Initializing hardware...");
 
-    // 1. Settings & Engine
-    RowingSettings settings;
-    RowingEngine engine(settings);
+    // 1. Settings & Engines (static: about 2KB per engine, kept off the main stack)
+    static DefaultRowingSettings<> settings;
+    static RowingEngine<> engines[CONFIG_ORM_ROWER_COUNT] = { LISTIFY(CONFIG_ORM_ROWER_COUNT, ROWER_ENGINE, (,)) };
+#ifndef CONFIG_ORM_SETTINGS_COMPILE_TIME
+    // Runtime changes (shell, BLE) are published here, the engines pick them up per impulse
+    static RowingSettingsStore settingsStore(settings);
+    for (RowingEngine<> &engine : engines) {
+        engine.followSettings(settingsStore);
+    }
+#endif
+#ifdef CONFIG_ORM_WARM_START
+    // Drag factors learned before the last reboot, saved again as they change
+    WarmStart warmStart;
+    warmStart.init(engines);
+#endif
 
     // 2. Hardware Timer Service
-    GpioTimerService gpioService(engine, settings);
+    GpioTimerService gpioService(engines, settings);
     if (gpioService.init() != 0) {
-        LOG_ERR("Failed to initialize GPIO. Check Devicetree alias 'impulse-sensor'");
+        LOG_ERR("Failed to initialize GPIO. Check Devicetree aliases 'impulse-sensor'(-N)");
         return 0;
     }
 
@@ -88,12 +112,19 @@ int main(void)
     FTMS ftmsService;
     ftmsService.init();
 
+#ifdef CONFIG_ORM_SETTINGS_BLE
+    SettingsService settingsService;
+    settingsService.init(settingsStore);
+#endif
+
     BleManager bleManager;
     bleManager.init(&mainLoopEvent);
 
-    // 4. The Bridge
-    RowerBridge bridge(engine, ftmsService, bleManager);
-    bridge.init();
+    // 4. The Bridges
+    RowerBridge bridges[CONFIG_ORM_ROWER_COUNT] = { LISTIFY(CONFIG_ORM_ROWER_COUNT, ROWER_BRIDGE, (,)) };
+    for (RowerBridge &bridge : bridges) {
+        bridge.init();
+    }
 
 #ifdef CONFIG_SYSM_ENABLE_MONITORING
     // 5. System Monitoring (Debug builds only)
@@ -105,54 +136,72 @@ int main(void)
     LOG_INF("System monitoring enabled (debug build)");
 #endif
 
+#ifdef CONFIG_ORM_SETTINGS_SHELL
+    SettingsShell settingsShell;
+    settingsShell.init(settingsStore);
+#endif
+
     // Print system info
     printSystemInfo();
 
     LOG_INF("✓ All systems operational. Ready to row.");
-    LOG_INF("Advertising as: %s", CONFIG_BT_DEVICE_NAME);
+    LOG_INF("Advertising as: %s (%d rowers)", CONFIG_BT_DEVICE_NAME, CONFIG_ORM_ROWER_COUNT);
     LOG_INF("");
 
-    engine.startSession();
-    k_sleep(K_FOREVER);
     // ================================================================
     // Main Loop
     // ================================================================
+    uint32_t sessionEvents = 0;
+    for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+        sessionEvents |= BLE_CONNECTED_EVENT(i) | BLE_DISCONNECTED_EVENT(i);
+    }
+    uint32_t activeRowers = 0;
+
     while(1) {
-        // Outer Loop
         // Block this thread indefinitely until a connection happens
         // This prevents the main thread from polling continously just to check if there is a connection
+        // While a rower has a session, wake up every 250ms to update the bridges
         // Event group is handled by BLE Manager
-
-        LOG_INF("Waiting for BLE connection.");
-        uint32_t connectedEvent = k_event_wait(&mainLoopEvent, BLE_CONNECTED_EVENT, true, K_FOREVER);
-        if(connectedEvent & BLE_CONNECTED_EVENT) {
-            LOG_INF("=== SESSION STARTED ===");
-            gpioService.resume();
-            // inputService.resume();
-            // fakeisr.start();
-            engine.startSession();
+        if (activeRowers == 0) {
+            LOG_INF("Waiting for BLE connection.");
+        }
+        uint32_t events = k_event_wait(&mainLoopEvent, sessionEvents, false,
+                                       (activeRowers == 0) ? K_FOREVER : K_MSEC(250));
+        k_event_clear(&mainLoopEvent, events);
+
+        for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+            if (events & BLE_CONNECTED_EVENT(i)) {
+                LOG_INF("=== SESSION STARTED (rower %d) ===", i);
+                gpioService.resume(i);
+                // inputService.resume();
+                // fakeisr.start();
+                engines[i].startSession();
+                activeRowers |= BIT(i);
+            }
+            if (events & BLE_DISCONNECTED_EVENT(i)) {
+                LOG_INF("=== SESSION ENDED (rower %d) ===", i);
+                gpioService.pause(i);
+                // inputService.pause();
+                // fakeisr.stop();
+                engines[i].endSession();
+#ifdef CONFIG_ORM_WARM_START
+                warmStart.sessionEnded();
+#endif
+                activeRowers &= ~BIT(i);
+            }
         }
-        while(1) {
-            // Inner Loop
-            // Active session, do all the work needed.
 
-            bridge.update();
-            // k_msleep(250);
+        // Active sessions, do all the work needed.
+        for (int i = 0; i < CONFIG_ORM_ROWER_COUNT; i++) {
+            if (activeRowers & BIT(i)) {
+                bridges[i].update();
+            }
+        }
 
 #ifdef CONFIG_SYSM_ENABLE_MONITORING
-            // System Monitoring (every 30 seconds, debug builds only)
-            monitor.update(30000);
+        // System Monitoring (every 30 seconds, debug builds only)
+        monitor.update(30000);
 #endif
-            uint32_t disconnectedEvent = k_event_wait(&mainLoopEvent, BLE_DISCONNECTED_EVENT, true, K_MSEC(250));
-            if(disconnectedEvent & BLE_DISCONNECTED_EVENT) {
-            LOG_INF("=== SESSION ENDED ===");
-            gpioService.pause();
-            // inputService.pause();
-            // fakeisr.stop();
-            engine.endSession();
-            break;
-            }
-        }
     }
 
     return 0;